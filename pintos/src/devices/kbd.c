@@ -7,6 +7,8 @@
 #include "devices/shutdown.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/spinlock.h"
+#include "threads/workqueue.h"
 
 /* Keyboard data register port. */
 #define DATA_REG 0x60
@@ -24,12 +26,24 @@ static bool caps_lock;
 /* Number of keys pressed. */
 static int64_t key_cnt;
 
+/* Scancodes read by the interrupt handler and not yet
+   interpreted.  The handler is the only writer of scan_head and
+   the worker the only writer of scan_tail, so no lock is
+   needed. */
+#define SCAN_BUFSIZE 32
+static uint16_t scan_buf[SCAN_BUFSIZE];
+static volatile unsigned scan_head, scan_tail;
+static struct work scan_work;
+
 static intr_handler_func keyboard_interrupt;
+static work_func keyboard_work;
+static void interpret_scancode (unsigned code);
 
 /* Initializes the keyboard. */
 void
 kbd_init (void) 
 {
+  work_init (&scan_work, keyboard_work, NULL);
   intr_register_ext (0x21, keyboard_interrupt, "8042 Keyboard");
 }
 
@@ -92,28 +106,60 @@ static const struct keymap shifted_keymap[] =
 
 static bool map_key (const struct keymap[], unsigned scancode, uint8_t *);
 
+/* Keyboard interrupt handler.  Reads the scancode, which
+   acknowledges the keyboard controller, and leaves interpreting
+   it to keyboard_work() on the high-priority workqueue.  If the
+   worker has fallen a whole buffer behind, the key is lost. */
 static void
 keyboard_interrupt (struct intr_frame *args UNUSED) 
+{
+  unsigned code;
+
+  /* Read scancode, including second byte if prefix code. */
+  code = inb (DATA_REG);
+  if (code == 0xe0)
+    code = (code << 8) | inb (DATA_REG);
+
+  if (scan_head - scan_tail < SCAN_BUFSIZE)
+    {
+      scan_buf[scan_head % SCAN_BUFSIZE] = code;
+      write_barrier ();
+      scan_head++;
+    }
+  work_queue (&wq_high, &scan_work);
+}
+
+/* Interprets the scancodes queued by keyboard_interrupt(). */
+static void
+keyboard_work (struct work *w UNUSED) 
+{
+  while (scan_tail != scan_head) 
+    {
+      unsigned code;
+
+      read_barrier ();
+      code = scan_buf[scan_tail % SCAN_BUFSIZE];
+      scan_tail++;
+      interpret_scancode (code);
+    }
+}
+
+/* Updates the shift state for, or adds to the input buffer the
+   character for, keyboard scancode CODE. */
+static void
+interpret_scancode (unsigned code) 
 {
   /* Status of shift keys. */
   bool shift = left_shift || right_shift;
   bool alt = left_alt || right_alt;
   bool ctrl = left_ctrl || right_ctrl;
 
-  /* Keyboard scancode. */
-  unsigned code;
-
   /* False if key pressed, true if key released. */
   bool release;
 
   /* Character that corresponds to `code'. */
   uint8_t c;
 
-  /* Read scancode, including second byte if prefix code. */
-  code = inb (DATA_REG);
-  if (code == 0xe0)
-    code = (code << 8) | inb (DATA_REG);
-
   /* Bit 0x80 distinguishes key press from key release
      (even if there's a prefix). */
   release = (code & 0x80) != 0;
@@ -133,6 +179,8 @@ keyboard_interrupt (struct intr_frame *args UNUSED)
       /* Ordinary character. */
       if (!release) 
         {
+          enum intr_level old_level;
+
           /* Reboot if Ctrl+Alt+Del pressed. */
           if (c == 0177 && ctrl && alt)
             shutdown_reboot ();
@@ -154,11 +202,13 @@ keyboard_interrupt (struct intr_frame *args UNUSED)
             c += 0x80;
 
           /* Append to keyboard buffer. */
+          old_level = intr_disable ();
           if (!input_full ())
             {
               key_cnt++;
               input_putc (c);
             }
+          intr_set_level (old_level);
         }
     }
   else
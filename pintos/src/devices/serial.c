@@ -1,7 +1,6 @@
 #include "devices/serial.h"
 #include <debug.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -33,6 +32,14 @@
 #define MCR_REG (IO_BASE + 4)   /* MODEM Control Register. */
 #define LSR_REG (IO_BASE + 5)   /* Line Status Register (read-only). */
 
+/* Interrupt Identification Register bits. */
+#define IIR_FIFO 0xc0           /* Both set if FIFOs are enabled. */
+
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable receive and transmit FIFOs. */
+#define FCR_CLEAR_RX 0x02       /* Discard bytes in receive FIFO. */
+#define FCR_CLEAR_TX 0x04       /* Discard bytes in transmit FIFO. */
+
 /* Interrupt Enable Register bits. */
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
@@ -47,13 +54,47 @@
 /* Line Status Register. */
 #define LSR_DR 0x01             /* Data Ready: received data byte is in RBR. */
 #define LSR_THRE 0x20           /* THR Empty. */
+#define LSR_TEMT 0x40           /* THR and transmit shift register empty. */
 
+/* Depth of the 16550A transmit FIFO, in bytes. */
+#define TX_FIFO_SIZE 16
+
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
-
+/* Data rate, in bits per second. */
+static int serial_bps = 115200;
+
+/* Number of bytes that may be written to THR at once when it is
+   empty: TX_FIFO_SIZE if the UART has working FIFOs, otherwise
+   1. */
+static int tx_burst = 1;
+
+/* Data to be transmitted.
+   This is a circular buffer filled by serial_putc() and
+   serial_putbuf() and drained by the transmit interrupt.  It is
+   much larger than an intq so that a process writing a lot of
+   console output can usually hand it off and continue without
+   waiting for the (slow) serial line.  TXQ_SIZE must be a power
+   of 2. */
+#define TXQ_SIZE 16384
+static uint8_t txq[TXQ_SIZE];
+static unsigned txq_head;       /* New data is written here. */
+static unsigned txq_tail;       /* Old data is read here. */
+
+/* A thread that finds the transmit queue full sleeps until the
+   transmit interrupt has drained it down to TXQ_LOW_WATER bytes,
+   so that it can then queue a large chunk at once instead of
+   waking for every FIFO's worth. */
+#define TXQ_LOW_WATER (TXQ_SIZE / 2)
+static struct lock txq_lock;    /* Only one thread may wait at once. */
+static struct thread *txq_waiter; /* Thread waiting for room. */
+
+static bool txq_empty (void);
+static bool txq_full (void);
+static void txq_putc (uint8_t, enum intr_level old_level);
+static void txq_wait (void);
+static uint8_t txq_getc (void);
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
@@ -68,10 +109,11 @@ init_poll (void)
 {
   ASSERT (mode == UNINIT);
   outb (IER_REG, 0);                    /* Turn off all interrupts. */
-  outb (FCR_REG, 0);                    /* Disable FIFO. */
-  set_serial (9600);                    /* 9.6 kbps, N-8-1. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RX | FCR_CLEAR_TX);
+  tx_burst = (inb (IIR_REG) & IIR_FIFO) == IIR_FIFO ? TX_FIFO_SIZE : 1;
+  set_serial (serial_bps);              /* N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
+  lock_init (&txq_lock);
   mode = POLL;
 } 
 
@@ -112,34 +154,77 @@ serial_putc (uint8_t byte)
     {
       /* Otherwise, queue a byte and update the interrupt enable
          register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
-        {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
-        }
-
-      intq_putc (&txq, byte); 
+      txq_putc (byte, old_level); 
       write_ier ();
     }
   
   intr_set_level (old_level);
 }
 
+/* Sends the N bytes in BUFFER to the serial port.
+   Equivalent to calling serial_putc() for each byte, but in
+   queued mode disables interrupts and updates the interrupt
+   enable register only once for the whole buffer.  Interrupts
+   are reenabled while waiting for room in the queue, if they
+   were on when we were called. */
+void
+serial_putbuf (const char *buffer, size_t n) 
+{
+  enum intr_level old_level;
+
+  if (mode != QUEUE)
+    {
+      while (n-- > 0)
+        serial_putc (*buffer++);
+      return;
+    }
+
+  old_level = intr_disable ();
+  while (n-- > 0)
+    txq_putc (*buffer++, old_level);
+  write_ier ();
+  intr_set_level (old_level);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (!txq_empty ())
+    putc_poll (txq_getc ());
   intr_set_level (old_level);
 }
 
+/* Sets the serial port's data rate to BPS bits per second.
+   BPS must evenly divide 115200, the 16550A's maximum rate.
+   Returns true if successful, false if BPS is not a supported
+   rate.  May be called before the serial port is initialized,
+   in which case the rate takes effect at initialization. */
+bool
+serial_set_bps (int bps) 
+{
+  enum intr_level old_level;
+
+  if (bps < 300 || bps > 115200 || 115200 % bps != 0)
+    return false;
+
+  old_level = intr_disable ();
+  serial_bps = bps;
+  if (mode != UNINIT)
+    {
+      /* Let bytes already queued go out at the old rate. */
+      while (!txq_empty ())
+        putc_poll (txq_getc ());
+      while ((inb (LSR_REG) & LSR_TEMT) == 0)
+        continue;
+      set_serial (bps);
+    }
+  intr_set_level (old_level);
+  return true;
+}
+
 /* The fullness of the input buffer may have changed.  Reassess
    whether we should block receive interrupts.
    Called by the input buffer routines when characters are added
@@ -182,7 +267,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (!txq_empty ())
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -218,11 +303,93 @@ serial_interrupt (struct intr_frame *f UNUSED)
   while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
     input_putc (inb (RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  /* If we have bytes to transmit and the hardware is ready to
+     accept them, refill the transmit FIFO.  THRE means the FIFO
+     is completely empty, so it has room for a full burst. */
+  if (!txq_empty () && (inb (LSR_REG) & LSR_THRE) != 0) 
+    {
+      int i;
+
+      for (i = 0; i < tx_burst && !txq_empty (); i++)
+        outb (THR_REG, txq_getc ());
+    }
+
+  /* Wake up a thread waiting for room in the queue once it has
+     drained far enough. */
+  if (txq_waiter != NULL && txq_head - txq_tail <= TXQ_LOW_WATER) 
+    {
+      thread_unblock (txq_waiter);
+      txq_waiter = NULL;
+    }
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
 }
+
+/* Returns true if the transmit queue is empty. */
+static bool
+txq_empty (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return txq_head == txq_tail;
+}
+
+/* Returns true if the transmit queue is full. */
+static bool
+txq_full (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return txq_head - txq_tail == TXQ_SIZE;
+}
+
+/* Adds BYTE to the end of the transmit queue.  Interrupts must
+   be off; OLD_LEVEL is the level our caller had them at.
+
+   If the queue is full and interrupts were on, sleeps until the
+   transmit interrupt makes room.  If they were off, then to wait
+   for the queue to drain we'd have to reenable them.  That's
+   impolite, so we send the oldest byte via polling instead. */
+static void
+txq_putc (uint8_t byte, enum intr_level old_level) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (txq_full ())
+    {
+      if (old_level == INTR_OFF)
+        putc_poll (txq_getc ());
+      else
+        txq_wait ();
+    }
+  txq[txq_head++ % TXQ_SIZE] = byte;
+}
+
+/* Sleeps until the transmit interrupt has drained the transmit
+   queue to TXQ_LOW_WATER bytes.  Interrupts must be off on entry
+   and are off on return, but are on while we sleep. */
+static void
+txq_wait (void) 
+{
+  ASSERT (!intr_context ());
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  lock_acquire (&txq_lock);
+  if (txq_full ())
+    {
+      /* The queue may have been filled without updating the
+         interrupt enable register yet. */
+      write_ier ();
+      txq_waiter = thread_current ();
+      thread_block ();
+    }
+  lock_release (&txq_lock);
+}
+
+/* Removes and returns the oldest byte in the transmit queue,
+   which must not be empty. */
+static uint8_t
+txq_getc (void) 
+{
+  ASSERT (!txq_empty ());
+  return txq[txq_tail++ % TXQ_SIZE];
+}
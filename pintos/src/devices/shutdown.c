@@ -6,6 +6,8 @@
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
 #endif
@@ -94,6 +96,7 @@ shutdown_power_off (void)
   filesys_done ();
 #endif
 
+  trace_dump ();
   print_stats ();
 
   printf ("Powering off...\n");
@@ -120,6 +123,8 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  thread_print_schedstat ();
+  workqueue_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
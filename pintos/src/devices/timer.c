@@ -4,6 +4,7 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
@@ -24,7 +25,110 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Hierarchical timing wheel holding every armed alarm.
+
+   Level 0 has one slot per tick for the next WHEEL_SIZE ticks.
+   Each slot of level N covers WHEEL_SIZE times as many ticks as
+   a slot of level N - 1.  An alarm is filed in the lowest level
+   whose range covers its expiry, so arming and cancelling are
+   O(1).  Whenever the level-0 index wraps around, the matching
+   slot one level up is "cascaded", that is, its alarms are
+   refiled into lower levels.  The timer interrupt therefore
+   only ever looks at the single level-0 slot for the current
+   tick, plus an occasional cascade, no matter how many alarms
+   are armed.  Alarms further out than the whole wheel covers
+   wait in the last level and are refiled as it cascades. */
+#define WHEEL_BITS 6                    /* Log2 of slots per level. */
+#define WHEEL_SIZE (1 << WHEEL_BITS)    /* Slots per level. */
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4                  /* Number of levels. */
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+/* Next tick whose level-0 slot has not yet been run. */
+static int64_t wheel_next;
+
+/* Tickless idle.
+
+   While the idle thread runs, timer_idle_enter() can replace
+   the periodic PIT interrupt with a single one-shot interrupt at
+   the next tick on which the timing wheel has work to do.  The
+   PIT counter is only 16 bits wide, so one interrupt can cover
+   at most IDLE_MAX_TICKS ticks.  The ticks skipped this way are
+   replayed, in order, when the one-shot interrupt arrives. */
+bool timer_tickless;
+
+/* PIT cycles per timer tick. */
+#define TICK_CYCLES ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Most ticks one PIT count can span. */
+#define IDLE_MAX_TICKS (0xffff / TICK_CYCLES)
+
+/* Number of ticks that will have gone by when the pending
+   one-shot interrupt arrives, or 0 if the PIT is periodic. */
+static int oneshot_ticks;
+
+/* PIT count loaded while idling, or 0 once timer_idle_exit() has
+   re-aimed the one-shot at the next tick boundary. */
+static uint16_t oneshot_count;
+
+/* Ticks known to have passed since the CPU stopped idling, but
+   not yet replayed by the timer interrupt. */
+static int oneshot_lag;
+
+/* High-resolution clock.
+
+   timer_calibrate() measures the CPU's time stamp counter
+   against the timer tick.  From then on timer_now_ns() turns TSC
+   readings into nanoseconds as CYCLES * tsc_mult >> tsc_shift,
+   with tsc_shift chosen so that tsc_mult fits in 32 bits.
+   Before calibration, timer_now_ns() only has tick
+   resolution. */
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_TICK (NSEC_PER_SEC / TIMER_FREQ)
+#define TSC_CALIBRATE_TICKS 5   /* Ticks to count TSC cycles over. */
+static uint64_t tsc_hz;         /* TSC cycles per second. */
+static uint64_t tsc_base;       /* TSC reading at calibration. */
+static int64_t tsc_base_ns;     /* timer_now_ns() at calibration. */
+static uint32_t tsc_mult;       /* 0 until calibrated. */
+static int tsc_shift;
+
+/* Sub-tick sleeps.
+
+   A thread that sleeps for less than a tick blocks on
+   hr_sleepers, which is ordered by deadline.  If the earliest
+   deadline comes before the next tick, the PIT is switched to a
+   one-shot count that ends at the deadline, and hr_rest is set
+   to the PIT cycles left from there to the tick.  That
+   interrupt wakes the sleepers that are due and aims the
+   one-shot at the next deadline or, if none comes first, at the
+   tick, whose interrupt then resumes the periodic tick in phase
+   as at the end of tickless idle. */
+struct hr_sleeper
+  {
+    struct list_elem elem;      /* Element in hr_sleepers. */
+    int64_t deadline;           /* timer_now_ns() to wake at. */
+    struct thread *thread;      /* The sleeping thread. */
+  };
+static struct list hr_sleepers;
+
+/* PIT cycles from the pending sub-tick deadline interrupt to the
+   next tick, or 0 if no such interrupt is pending. */
+static unsigned hr_rest;
+
 static intr_handler_func timer_interrupt;
+static void wheel_add (struct alarm *);
+static void wheel_cascade (int level, int idx);
+static void wheel_advance (void);
+static int wheel_quiet_ticks (int max);
+static void timer_tick (bool idle);
+static void tsc_calibrate (void);
+static void hr_sleep (int64_t ns);
+static void hr_arm (void);
+static bool hr_program (unsigned to_tick);
+static void hr_wake (void);
+static void hr_interrupt (void);
+static bool hr_less (const struct list_elem *, const struct list_elem *,
+                     void *aux);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -35,11 +139,20 @@ static void real_time_delay (int64_t num, int32_t denom);
 void
 timer_init (void) 
 {
+  int level, idx;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    for (idx = 0; idx < WHEEL_SIZE; idx++)
+      list_init (&wheel[level][idx]);
+  wheel_next = ticks + 1;
+  list_init (&hr_sleepers);
+
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Calibrates loops_per_tick, used to implement brief delays,
+   and the time stamp counter, used by timer_now_ns(). */
 void
 timer_calibrate (void) 
 {
@@ -63,7 +176,46 @@ timer_calibrate (void)
     if (!too_many_loops (high_bit | test_bit))
       loops_per_tick |= test_bit;
 
-  printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+  tsc_calibrate ();
+  printf ("%'"PRIu64" loops/s, %'"PRIu64" TSC cycles/s.\n",
+          (uint64_t) loops_per_tick * TIMER_FREQ, tsc_hz);
+}
+
+/* Counts TSC cycles over TSC_CALIBRATE_TICKS ticks and sets up
+   the conversion from cycles to nanoseconds. */
+static void
+tsc_calibrate (void) 
+{
+  enum intr_level old_level;
+  int64_t start;
+  uint64_t tsc0, mult;
+
+  /* Wait for a tick, then count cycles to a later one. */
+  start = ticks;
+  while (ticks == start)
+    barrier ();
+  tsc0 = rdtsc ();
+  start = ticks;
+  while (ticks - start < TSC_CALIBRATE_TICKS)
+    barrier ();
+  tsc_hz = (rdtsc () - tsc0) * TIMER_FREQ / TSC_CALIBRATE_TICKS;
+  ASSERT (tsc_hz != 0);
+
+  /* Largest shift whose multiplier fits in 32 bits. */
+  for (tsc_shift = 32; ; tsc_shift--)
+    {
+      mult = (NSEC_PER_SEC << tsc_shift) / tsc_hz;
+      if (mult <= UINT32_MAX || tsc_shift == 0)
+        break;
+    }
+
+  /* Start the TSC clock where the tick clock is, so that
+     timer_now_ns() never goes backward. */
+  old_level = intr_disable ();
+  tsc_base = rdtsc ();
+  tsc_base_ns = ticks * NSEC_PER_TICK;
+  tsc_mult = mult;
+  intr_set_level (old_level);
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -71,11 +223,100 @@ int64_t
 timer_ticks (void) 
 {
   enum intr_level old_level = intr_disable ();
-  int64_t t = ticks;
+  int64_t t = ticks + oneshot_lag;
   intr_set_level (old_level);
   return t;
 }
 
+/* Returns the number of nanoseconds since the OS booted.  The
+   value never decreases.  Resolution is that of the time stamp
+   counter once timer_calibrate() has run, one tick before. */
+int64_t
+timer_now_ns (void) 
+{
+  uint64_t cycles;
+
+  if (tsc_mult == 0)
+    return timer_ticks () * NSEC_PER_TICK;
+
+  /* CYCLES * tsc_mult would overflow 64 bits, so multiply the
+     high and low halves separately. */
+  cycles = rdtsc () - tsc_base;
+  return tsc_base_ns
+         + (int64_t) ((((cycles >> 32) * tsc_mult) << (32 - tsc_shift))
+                      + (((cycles & 0xffffffff) * tsc_mult) >> tsc_shift));
+}
+
+/* Called by the idle thread, with interrupts off, just before it
+   halts the CPU.  In tickless mode, stops the periodic tick and
+   instead arranges for a single timer interrupt at the next tick
+   that has alarms due, at most IDLE_MAX_TICKS away. */
+void
+timer_idle_enter (void) 
+{
+  uint16_t left;
+  int n;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless || oneshot_ticks != 0 || hr_rest != 0
+      || !list_empty (&hr_sleepers))
+    return;
+  n = wheel_quiet_ticks (IDLE_MAX_TICKS);
+  if (n < 2)
+    return;
+
+  /* Line the one-shot up with the N'th periodic tick, so that
+     the tick keeps its phase. */
+  left = pit_read_counter (0);
+  if (left == 0 || left > TICK_CYCLES)
+    return;
+  oneshot_count = (n - 1) * TICK_CYCLES + left;
+  oneshot_ticks = n;
+  pit_configure_oneshot (0, oneshot_count);
+
+  /* A periodic tick that came due just before the switch would
+     otherwise be taken for the one-shot.  Go back to periodic
+     mode and let it be handled normally. */
+  if (intr_ext_pending (0x20))
+    {
+      oneshot_ticks = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+    }
+}
+
+/* Called by the scheduler, with interrupts off, when the idle
+   thread gives up the CPU to another thread.  If the CPU was
+   idling without a periodic tick, works out how many ticks have
+   gone by, so that timer_ticks() stays accurate, and aims the
+   one-shot at the next tick boundary.  That interrupt replays
+   the missed ticks and restarts the periodic tick in phase. */
+void
+timer_idle_exit (void) 
+{
+  uint16_t left;
+  int remaining;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks == 0 || oneshot_count == 0)
+    return;
+
+  /* If the count already ran out, the one-shot interrupt is
+     pending and will do all the work. */
+  left = pit_read_counter (0);
+  if (left == 0 || left > oneshot_count)
+    return;
+
+  /* Tick boundaries fall LEFT, LEFT - TICK_CYCLES, ... cycles
+     from now, down to 0 cycles (when the count runs out). */
+  remaining = DIV_ROUND_UP (left, TICK_CYCLES);
+  oneshot_lag = oneshot_ticks - remaining;
+  oneshot_ticks = oneshot_lag + 1;
+  oneshot_count = 0;
+  pit_configure_oneshot (0, (left - 1) % TICK_CYCLES + 1);
+}
+
 /* Returns the number of timer ticks elapsed since THEN, which
    should be a value once returned by timer_ticks(). */
 int64_t
@@ -89,23 +330,16 @@ timer_elapsed (int64_t then)
 void
 timer_sleep (int64_t ticks) 
 {
-  // Project 1. threads. Reimplement it to avoid busy wait.
-  // while loop --> time checking. 
-  // elapsed < ticks : block 
-  // elapsed >= ticks : insert thread into ready queue.
-  // compute recent cpu, load_avg, nice ...
   int64_t start = timer_ticks ();
+  enum intr_level old_level;
 
   ASSERT (intr_get_level () == INTR_ON);
-#ifdef USERPROG
-  while (timer_elapsed (start) < ticks) 
-    thread_yield ();
-#else
-  enum intr_level old_level = intr_disable();
-  thread_sleep(start + ticks);
-  thread_block();
-  intr_set_level(old_level);
-#endif
+  if (ticks <= 0)
+    return;
+
+  old_level = intr_disable ();
+  thread_sleep (start + ticks);
+  intr_set_level (old_level);
 }
 
 /* Sleeps for approximately MS milliseconds.  Interrupts must be
@@ -178,12 +412,352 @@ timer_print_stats (void)
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Initializes ALARM to call FUNC(AUX) when it goes off.  The
+   alarm starts out disarmed. */
+void
+alarm_init (struct alarm *alarm, alarm_func *func, void *aux)
+{
+  ASSERT (alarm != NULL);
+  ASSERT (func != NULL);
+
+  alarm->func = func;
+  alarm->aux = aux;
+  alarm->expires = 0;
+  alarm->period = 0;
+  alarm->armed = false;
+}
+
+/* Arms ALARM to go off at tick EXPIRES, and then every PERIOD
+   ticks after that if PERIOD is positive.  An alarm whose
+   EXPIRES has already passed goes off at the next tick.  If
+   ALARM was already armed, its old expiry is forgotten.
+
+   This function may be called from an interrupt handler,
+   including from an alarm function. */
+void
+alarm_set (struct alarm *alarm, int64_t expires, int64_t period)
+{
+  enum intr_level old_level;
+
+  ASSERT (alarm != NULL);
+  ASSERT (period >= 0);
+
+  old_level = intr_disable ();
+  if (alarm->armed)
+    list_remove (&alarm->elem);
+  alarm->expires = expires;
+  alarm->period = period;
+  alarm->armed = true;
+  wheel_add (alarm);
+  intr_set_level (old_level);
+}
+
+/* Disarms ALARM, if it is armed.  Once this function returns,
+   ALARM's function will not be called until it is armed
+   again.
+
+   This function may be called from an interrupt handler,
+   including from an alarm function. */
+void
+alarm_cancel (struct alarm *alarm)
+{
+  enum intr_level old_level;
+
+  ASSERT (alarm != NULL);
+
+  old_level = intr_disable ();
+  if (alarm->armed)
+    {
+      list_remove (&alarm->elem);
+      alarm->armed = false;
+    }
+  intr_set_level (old_level);
+}
+
+/* Returns true if ALARM is armed, false otherwise. */
+bool
+alarm_pending (const struct alarm *alarm)
+{
+  ASSERT (alarm != NULL);
+
+  return alarm->armed;
+}
+
+/* Files ALARM in the timing wheel slot that covers its expiry.
+   Interrupts must be off. */
+static void
+wheel_add (struct alarm *alarm)
+{
+  int64_t expires = alarm->expires;
+  int64_t delta = expires - wheel_next;
+  int level;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (delta < 0)
+    {
+      /* Already expired: go off at the next tick. */
+      expires = wheel_next;
+      delta = 0;
+    }
+  else if (delta >= (int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS))
+    {
+      /* Beyond the wheel's range: park at the far end of the
+         last level.  It will be refiled when that slot
+         cascades. */
+      delta = ((int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+      expires = wheel_next + delta;
+    }
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    if (delta < (int64_t) 1 << (WHEEL_BITS * (level + 1)))
+      break;
+
+  list_push_back (&wheel[level][(expires >> (WHEEL_BITS * level))
+                                & WHEEL_MASK],
+                  &alarm->elem);
+}
+
+/* Refiles the alarms in slot IDX of LEVEL into lower levels. */
+static void
+wheel_cascade (int level, int idx)
+{
+  struct list *slot = &wheel[level][idx];
+
+  while (!list_empty (slot))
+    wheel_add (list_entry (list_pop_front (slot), struct alarm, elem));
+}
+
+/* Runs the level-0 slots of every tick up to and including the
+   current one, cascading higher levels as their turn comes.
+   Called from the timer interrupt. */
+static void
+wheel_advance (void)
+{
+  while (wheel_next <= ticks)
+    {
+      int64_t now = wheel_next;
+      int idx = now & WHEEL_MASK;
+      struct list expired;
+      int level;
+
+      /* Cascade each level whose lower neighbor just wrapped. */
+      for (level = 1; idx == 0 && level < WHEEL_LEVELS; level++)
+        {
+          idx = (now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+          wheel_cascade (level, idx);
+        }
+      idx = now & WHEEL_MASK;
+
+      /* Take this tick's slot and move on to the next tick
+         before calling any alarm functions, so that alarms they
+         arm land in a future slot. */
+      list_init (&expired);
+      list_splice (list_end (&expired), list_begin (&wheel[0][idx]),
+                   list_end (&wheel[0][idx]));
+      wheel_next++;
+
+      while (!list_empty (&expired))
+        {
+          struct alarm *alarm = list_entry (list_pop_front (&expired),
+                                            struct alarm, elem);
+          if (alarm->period > 0)
+            {
+              alarm->expires += alarm->period;
+              wheel_add (alarm);
+            }
+          else
+            alarm->armed = false;
+          alarm->func (alarm->aux);
+        }
+    }
+}
+
+/* Returns the number of ticks from now until the next tick, at
+   most MAX, on which the timing wheel has alarms to run or a
+   slot to cascade. */
+static int
+wheel_quiet_ticks (int max) 
+{
+  int n;
+
+  ASSERT (wheel_next == ticks + 1);
+
+  for (n = 1; n < max; n++)
+    {
+      int idx = (ticks + n) & WHEEL_MASK;
+      if (idx == 0 || !list_empty (&wheel[0][idx]))
+        break;
+    }
+  return n;
+}
+
+/* Advances the tick count by one and does the per-tick work.
+   IDLE is true for a tick that went by while the CPU idled
+   without a periodic tick. */
+static void
+timer_tick (bool idle) 
+{
+  ticks++;
+  if (idle)
+    thread_tick_idle ();
+  else
+    thread_tick ();
+  wheel_advance ();
+}
+
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
 {
-  ticks++;
-  thread_tick ();
+  if (hr_rest != 0)
+    {
+      /* Not a tick, but a sub-tick sleep deadline. */
+      hr_interrupt ();
+      return;
+    }
+
+  if (oneshot_ticks != 0)
+    {
+      /* End of a tickless idle stretch: resume the periodic
+         tick and catch up on the ticks that went by. */
+      int skipped = oneshot_ticks - 1;
+
+      oneshot_ticks = 0;
+      oneshot_count = 0;
+      oneshot_lag = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+      while (skipped-- > 0)
+        timer_tick (true);
+    }
+  timer_tick (false);
+
+  /* Wake sub-tick sleepers that are due, and aim the PIT at the
+     next one if it comes before the next tick. */
+  hr_wake ();
+  hr_arm ();
+}
+
+/* Blocks the running thread for NS nanoseconds, which should be
+   less than a tick.  Interrupts must be on. */
+static void
+hr_sleep (int64_t ns) 
+{
+  struct hr_sleeper s;
+  enum intr_level old_level;
+
+  ASSERT (intr_get_level () == INTR_ON);
+  if (ns <= 0)
+    return;
+
+  s.thread = thread_current ();
+  old_level = intr_disable ();
+  s.deadline = timer_now_ns () + ns;
+  list_insert_ordered (&hr_sleepers, &s.elem, hr_less, NULL);
+  if (list_front (&hr_sleepers) == &s.elem)
+    hr_arm ();
+  thread_block ();
+  intr_set_level (old_level);
+}
+
+/* Aims the PIT at the earliest sub-tick deadline, if it comes
+   before the next tick.  Interrupts must be off. */
+static void
+hr_arm (void) 
+{
+  uint16_t left;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* In tickless idle the PIT may be counting down several
+     ticks; the deadline will be handled when it ends. */
+  if (oneshot_count != 0 || list_empty (&hr_sleepers))
+    return;
+
+  /* LEFT is the count to the next interrupt, which is either
+     the next tick or a pending deadline HR_REST cycles before
+     it.  If the count already ran out, the interrupt is pending
+     and will call us again. */
+  left = pit_read_counter (0);
+  if (left == 0 || left > TICK_CYCLES)
+    return;
+  hr_program (hr_rest != 0 ? left + hr_rest : left);
+}
+
+/* If the earliest sub-tick deadline comes less than TO_TICK PIT
+   cycles from now, that is, before the next tick, starts a
+   one-shot PIT count that ends at the deadline and returns true.
+   Otherwise returns false without touching the PIT. */
+static bool
+hr_program (unsigned to_tick) 
+{
+  struct hr_sleeper *s;
+  int64_t delta;
+  unsigned cycles;
+
+  if (list_empty (&hr_sleepers))
+    return false;
+  s = list_entry (list_front (&hr_sleepers), struct hr_sleeper, elem);
+  delta = s->deadline - timer_now_ns ();
+  if (delta >= NSEC_PER_TICK)
+    return false;
+  cycles = delta > 0 ? DIV_ROUND_UP (delta * PIT_HZ, NSEC_PER_SEC) : 1;
+  if (cycles >= to_tick)
+    return false;
+
+  pit_configure_oneshot (0, cycles);
+  hr_rest = to_tick - cycles;
+  return true;
+}
+
+/* Wakes every sub-tick sleeper whose deadline has been
+   reached. */
+static void
+hr_wake (void) 
+{
+  int64_t now = timer_now_ns ();
+
+  while (!list_empty (&hr_sleepers))
+    {
+      struct hr_sleeper *s = list_entry (list_front (&hr_sleepers),
+                                         struct hr_sleeper, elem);
+      if (s->deadline > now)
+        break;
+      list_pop_front (&hr_sleepers);
+      thread_unblock (s->thread);
+      if (thread_preempts (s->thread))
+        intr_yield_on_return ();
+    }
+}
+
+/* Handles the interrupt for a sub-tick deadline: wakes the
+   sleepers that are due, then aims the PIT at the next deadline
+   or else at the next tick.  The tick's interrupt restarts the
+   periodic tick the same way the end of tickless idle does. */
+static void
+hr_interrupt (void) 
+{
+  unsigned to_tick = hr_rest;
+
+  hr_rest = 0;
+  hr_wake ();
+  if (!hr_program (to_tick))
+    {
+      pit_configure_oneshot (0, to_tick);
+      if (oneshot_ticks == 0)
+        oneshot_ticks = 1;
+    }
+}
+
+/* Orders hr_sleepers by deadline. */
+static bool
+hr_less (const struct list_elem *a_, const struct list_elem *b_,
+         void *aux UNUSED) 
+{
+  const struct hr_sleeper *a = list_entry (a_, struct hr_sleeper, elem);
+  const struct hr_sleeper *b = list_entry (b_, struct hr_sleeper, elem);
+
+  return a->deadline < b->deadline;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -239,10 +813,16 @@ real_time_sleep (int64_t num, int32_t denom)
          processes. */                
       timer_sleep (ticks); 
     }
+  else if (tsc_mult != 0)
+    {
+      /* Otherwise, block until a one-shot timer interrupt at
+         the deadline.  DENOM divides NSEC_PER_SEC. */
+      hr_sleep (num * (NSEC_PER_SEC / denom));
+    }
   else 
     {
-      /* Otherwise, use a busy-wait loop for more accurate
-         sub-tick timing. */
+      /* Before the clock is calibrated, use a busy-wait loop
+         for more accurate sub-tick timing. */
       real_time_delay (num, denom); 
     }
 }
@@ -1,17 +1,43 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Function called when an alarm goes off.  Runs in the timer
+   interrupt handler, so it must not sleep. */
+typedef void alarm_func (void *aux);
+
+/* A kernel alarm.  Once armed, calls FUNC(AUX) from the timer
+   interrupt when the tick count reaches EXPIRES, and then again
+   every PERIOD ticks if PERIOD is positive. */
+struct alarm
+  {
+    struct list_elem elem;      /* Element in a timing wheel slot. */
+    int64_t expires;            /* Tick at which to go off. */
+    int64_t period;             /* Re-arm interval, or 0 for one-shot. */
+    alarm_func *func;           /* Function to call. */
+    void *aux;                  /* Auxiliary data for FUNC. */
+    bool armed;                 /* True while on the timing wheel. */
+  };
+
+/* If true, the periodic tick stops while the CPU is idle.
+   Controlled by kernel command-line option "-tickless". */
+extern bool timer_tickless;
+
 void timer_init (void);
 void timer_calibrate (void);
+void timer_idle_enter (void);
+void timer_idle_exit (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_now_ns (void);
 
 /* Sleep and yield the CPU to other threads. */
 void timer_sleep (int64_t ticks);
@@ -26,4 +52,10 @@ void timer_ndelay (int64_t nanoseconds);
 
 void timer_print_stats (void);
 
+/* Alarms. */
+void alarm_init (struct alarm *, alarm_func *, void *aux);
+void alarm_set (struct alarm *, int64_t expires, int64_t period);
+void alarm_cancel (struct alarm *);
+bool alarm_pending (const struct alarm *);
+
 #endif /* devices/timer.h */
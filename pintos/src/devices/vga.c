@@ -31,6 +31,7 @@ static void cls (void);
 static void newline (void);
 static void move_cursor (void);
 static void find_cursor (size_t *x, size_t *y);
+static void putc_no_cursor (int c, enum intr_level old_level);
 
 /* Initializes the VGA text display. */
 static void
@@ -56,7 +57,40 @@ vga_putc (int c)
   enum intr_level old_level = intr_disable ();
 
   init ();
-  
+  putc_no_cursor (c, old_level);
+
+  /* Update cursor position. */
+  move_cursor ();
+
+  intr_set_level (old_level);
+}
+
+/* Writes the N characters in BUFFER to the VGA text display, as
+   if by calling vga_putc() for each one, but moves the hardware
+   cursor only once at the end.  Programming the cursor takes
+   several slow port writes, so doing it per character dominates
+   the cost of large writes. */
+void
+vga_putbuf (const char *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  init ();
+  while (n-- > 0)
+    putc_no_cursor (*buffer++, old_level);
+  move_cursor ();
+
+  intr_set_level (old_level);
+}
+
+/* Writes C to the framebuffer and advances (cx,cy), without
+   updating the hardware cursor.  Interrupts must be off;
+   OLD_LEVEL is the level to restore temporarily while beeping. */
+static void
+putc_no_cursor (int c, enum intr_level old_level) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
   switch (c) 
     {
     case '\n':
@@ -95,11 +129,6 @@ vga_putc (int c)
         newline ();
       break;
     }
-
-  /* Update cursor position. */
-  move_cursor ();
-
-  intr_set_level (old_level);
 }
 
 /* Clears the screen and moves the cursor to the upper left. */
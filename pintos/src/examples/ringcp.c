@@ -0,0 +1,117 @@
+/* ringcp.c
+
+   Copies one file to another like cp, but through the I/O rings,
+   keeping a batch of reads and then a batch of writes in each
+   ioring_enter() call. */
+
+#include <stdio.h>
+#include <syscall.h>
+
+/* Chunks per batch, and bytes per chunk. */
+#define BATCH 16
+#define CHUNK 1024
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+static char buffers[BATCH][CHUNK];
+
+/* Submits operation OP on FD for chunk I of the batch, at file
+   offset OFS. */
+static void
+submit (enum ioring_op op, int fd, int i, unsigned len, int ofs) 
+{
+  struct ioring_sqe *sqe = &ring.sq[ring.sq_tail % IORING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buffers[i];
+  sqe->len = len;
+  sqe->offset = ofs;
+  sqe->user_data = i;
+  ring.sq_tail++;
+}
+
+/* Carries out the submitted operations and stores the result for
+   each chunk in RESULTS. */
+static void
+complete (int results[BATCH]) 
+{
+  ioring_enter ();
+  while (ring.cq_head != ring.cq_tail)
+    {
+      struct ioring_cqe *cqe = &ring.cq[ring.cq_head++ % IORING_ENTRIES];
+      results[cqe->user_data] = cqe->result;
+    }
+}
+
+int
+main (int argc, char *argv[]) 
+{
+  int in_fd, out_fd;
+  int ofs = 0;
+  bool eof = false;
+
+  if (argc != 3) 
+    {
+      printf ("usage: ringcp OLD NEW\n");
+      return EXIT_FAILURE;
+    }
+
+  in_fd = open (argv[1]);
+  if (in_fd < 0) 
+    {
+      printf ("%s: open failed\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+  if (!create (argv[2], filesize (in_fd))) 
+    {
+      printf ("%s: create failed\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+  out_fd = open (argv[2]);
+  if (out_fd < 0) 
+    {
+      printf ("%s: open failed\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+  if (!ioring_setup (&ring)) 
+    {
+      printf ("ioring_setup failed\n");
+      return EXIT_FAILURE;
+    }
+
+  while (!eof)
+    {
+      int reads[BATCH], writes[BATCH];
+      int i, n;
+
+      for (i = 0; i < BATCH; i++)
+        submit (IORING_OP_READ, in_fd, i, CHUNK, ofs + i * CHUNK);
+      complete (reads);
+
+      /* Write back the chunks up to the first short read. */
+      for (n = 0; n < BATCH && !eof; n++)
+        {
+          if (reads[n] < 0) 
+            {
+              printf ("%s: read failed\n", argv[1]);
+              return EXIT_FAILURE;
+            }
+          if (reads[n] > 0)
+            submit (IORING_OP_WRITE, out_fd, n, reads[n], ofs + n * CHUNK);
+          else
+            writes[n] = 0;
+          eof = reads[n] < CHUNK;
+        }
+      complete (writes);
+
+      for (i = 0; i < n; i++)
+        if (writes[i] != reads[i]) 
+          {
+            printf ("%s: write failed\n", argv[2]);
+            return EXIT_FAILURE;
+          }
+      ofs += BATCH * CHUNK;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+/* schedstat.c
+
+   Prints this process's scheduler latency histograms, after
+   optionally spinning for the number of iterations given on the
+   command line so that it gets preempted a few times. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Written in the busy loop, so that it is not optimized away. */
+static volatile int spin;
+
+static void
+print_hist (const char *name, const uint32_t *hist)
+{
+  int b;
+
+  printf ("%s:", name);
+  for (b = 0; b < SCHEDSTAT_BUCKETS; b++)
+    if (hist[b] != 0)
+      printf (" <2^%d:%u", SCHEDSTAT_SHIFT + b, (unsigned) hist[b]);
+  printf ("\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+  static struct schedstat stats;
+  int i, n = argc > 1 ? atoi (argv[1]) : 0;
+
+  for (i = 0; i < n; i++)
+    spin = i;
+
+  if (!schedstat (&stats))
+    return EXIT_FAILURE;
+
+  printf ("%u voluntary, %u involuntary switches\n",
+          (unsigned) stats.voluntary, (unsigned) stats.involuntary);
+  print_hist ("wait", stats.hist[SCHEDSTAT_WAIT]);
+  print_hist ("run", stats.hist[SCHEDSTAT_RUN]);
+  print_hist ("wakeup", stats.hist[SCHEDSTAT_WAKEUP]);
+  return EXIT_SUCCESS;
+}
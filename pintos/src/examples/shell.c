@@ -32,9 +32,20 @@ main (void)
         }
       else
         {
-          pid_t pid = exec (command);
+          /* "nice CMD" runs CMD at the lowest priority, for
+             batch jobs. */
+          bool batch = !memcmp (command, "nice ", 5);
+          const char *cmd = batch ? command + 5 : command;
+          pid_t pid = exec (cmd);
           if (pid != PID_ERROR)
-            printf ("\"%s\": exit code %d\n", command, wait (pid));
+            {
+              if (batch)
+                {
+                  setpriority (pid, PRIO_MIN);
+                  nice (pid, NICE_MAX);
+                }
+              printf ("\"%s\": exit code %d\n", cmd, wait (pid));
+            }
           else
             printf ("exec failed\n");
         }
@@ -0,0 +1,64 @@
+/* sysbench.c
+
+   Measures the round-trip cost of a system call that does no
+   work, in CPU cycles: first through the system call library,
+   which uses whatever entry path it was built with (see
+   SYSCALL_ENTRY in Makefile.userprog), then through the `int
+   $0x30' interrupt gate directly, for comparison.  The number of
+   calls to time may be given on the command line. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include <syscall-nr.h>
+
+/* Returns the time stamp counter. */
+static inline uint64_t
+rdtsc (void) 
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Calls sum_of_four_integers() through `int $0x30'. */
+static inline int
+sum_int (int a, int b, int c, int d) 
+{
+  int retval;
+  asm volatile
+    ("pushl %[d]; pushl %[c]; pushl %[b]; pushl %[a]; "
+     "pushl %[number]; int $0x30; addl $20, %%esp"
+       : "=a" (retval)
+       : [number] "i" (SYS_SUM),
+         [a] "r" (a), [b] "r" (b), [c] "r" (c), [d] "r" (d)
+       : "memory");
+  return retval;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int i, n = argc > 1 ? atoi (argv[1]) : 10000;
+  uint64_t start, lib, gate;
+
+  if (n <= 0)
+    return EXIT_FAILURE;
+
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    if (sum_of_four_integers (i, 1, 2, 3) != i + 6)
+      return EXIT_FAILURE;
+  lib = rdtsc () - start;
+
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    if (sum_int (i, 1, 2, 3) != i + 6)
+      return EXIT_FAILURE;
+  gate = rdtsc () - start;
+
+  printf ("%d calls: library %u cycles/call, int $0x30 %u cycles/call\n",
+          n, (unsigned) (lib / n), (unsigned) (gate / n));
+  return EXIT_SUCCESS;
+}
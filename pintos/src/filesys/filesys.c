@@ -10,6 +10,9 @@
 /* Partition that contains the file system. */
 struct block *fs_device;
 
+/* File system lock. */
+struct rwlock filesys_lock;
+
 static void do_format (void);
 
 /* Initializes the file system module.
@@ -21,6 +24,7 @@ filesys_init (bool format)
   if (fs_device == NULL)
     PANIC ("No file system device found, can't initialize file system.");
 
+  rwlock_init (&filesys_lock);
   inode_init ();
   free_map_init ();
 
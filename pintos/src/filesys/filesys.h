@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include "filesys/off_t.h"
+#include "threads/synch.h"
 
 /* Sectors of system file inodes. */
 #define FREE_MAP_SECTOR 0       /* Free map file inode sector. */
@@ -11,6 +12,11 @@
 /* Block device that contains the file system. */
 struct block *fs_device;
 
+/* Serializes file system calls from user programs.  Calls that
+   only look things up or read take it shared; calls that change
+   on-disk state take it exclusive. */
+extern struct rwlock filesys_lock;
+
 void filesys_init (bool format);
 void filesys_done (void);
 bool filesys_create (const char *name, off_t initial_size);
@@ -0,0 +1,61 @@
+#ifndef __LIB_IORING_H
+#define __LIB_IORING_H
+
+#include <stdint.h>
+
+/* A submission ring and a completion ring for batching I/O
+   system calls, shared between a user program and the kernel.
+
+   The program registers a page-aligned struct ioring with
+   ioring_setup(), which zeroes its indexes.  To submit
+   operations it fills in sq[sq_tail % IORING_ENTRIES] and
+   increments sq_tail, any number of times.  One call to
+   ioring_enter() then carries out every submitted operation, in
+   order, for which the completion ring has room, advancing
+   sq_head past each and posting its result at
+   cq[cq_tail % IORING_ENTRIES].  The program consumes results by
+   advancing cq_head.
+
+   The indexes run freely and wrap around at 2**32; a ring is
+   empty when its head equals its tail. */
+#define IORING_ENTRIES 64               /* Entries per ring. */
+
+/* Operations. */
+enum ioring_op
+  {
+    IORING_OP_NOP,              /* Does nothing; result 0. */
+    IORING_OP_READ,             /* read() or pread(). */
+    IORING_OP_WRITE,            /* write() or pwrite(). */
+    IORING_OP_OPEN,             /* open(), with the file name in BUF. */
+    IORING_OP_CLOSE             /* close(); result 0 or -1. */
+  };
+
+/* A submitted operation. */
+struct ioring_sqe
+  {
+    uint32_t op;                /* An enum ioring_op. */
+    int32_t fd;                 /* File descriptor. */
+    void *buf;                  /* Buffer, or file name for OPEN. */
+    uint32_t len;               /* Size of BUF for READ and WRITE. */
+    int32_t offset;             /* File offset, or -1 for the position. */
+    uint32_t user_data;         /* Copied to the completion. */
+  };
+
+/* A completed operation. */
+struct ioring_cqe
+  {
+    uint32_t user_data;         /* From the submission. */
+    int32_t result;             /* What the system call would return. */
+  };
+
+struct ioring
+  {
+    uint32_t sq_head;           /* Next submission; kernel advances. */
+    uint32_t sq_tail;           /* Next free submission; user advances. */
+    uint32_t cq_head;           /* Next completion; user advances. */
+    uint32_t cq_tail;           /* Next free completion; kernel advances. */
+    struct ioring_sqe sq[IORING_ENTRIES];
+    struct ioring_cqe cq[IORING_ENTRIES];
+  };
+
+#endif /* lib/ioring.h */
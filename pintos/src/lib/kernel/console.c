@@ -148,13 +148,17 @@ puts (const char *s)
   return 0;
 }
 
-/* Writes the N characters in BUFFER to the console. */
+/* Writes the N characters in BUFFER to the console.
+   The whole buffer is handed to the serial and vga layers at
+   once, so the serial bytes are queued for the transmit
+   interrupt and the vga cursor is updated only once. */
 void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  write_cnt += n;
+  serial_putbuf (buffer, n);
+  vga_putbuf (buffer, n);
   release_console ();
 }
 
@@ -0,0 +1,35 @@
+#ifndef __LIB_SCHEDSTAT_H
+#define __LIB_SCHEDSTAT_H
+
+#include <stdint.h>
+
+/* Per-thread scheduler statistics, kept by the kernel and
+   returned to user programs by the schedstat system call.
+
+   Each histogram counts intervals measured in time stamp counter
+   cycles, by powers of two.  Bucket 0 counts intervals shorter
+   than 2**SCHEDSTAT_SHIFT cycles; bucket B, for 0 < B <
+   SCHEDSTAT_BUCKETS - 1, counts intervals of at least
+   2**(SCHEDSTAT_SHIFT + B - 1) but less than
+   2**(SCHEDSTAT_SHIFT + B) cycles; the last bucket counts
+   everything longer. */
+#define SCHEDSTAT_SHIFT 8
+#define SCHEDSTAT_BUCKETS 24
+
+/* The histograms. */
+enum schedstat_hist
+  {
+    SCHEDSTAT_WAIT,             /* Ready, until it starts running. */
+    SCHEDSTAT_RUN,              /* Running, until it switches out. */
+    SCHEDSTAT_WAKEUP,           /* Unblocked, until it starts running. */
+    SCHEDSTAT_HIST_CNT
+  };
+
+struct schedstat
+  {
+    uint32_t hist[SCHEDSTAT_HIST_CNT][SCHEDSTAT_BUCKETS];
+    uint32_t voluntary;         /* Switches away by blocking or exiting. */
+    uint32_t involuntary;       /* Switches away while still ready. */
+  };
+
+#endif /* lib/schedstat.h */
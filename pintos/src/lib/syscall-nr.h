@@ -32,6 +32,24 @@ enum
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
     SYS_INUMBER,                /* Returns the inode number for a fd. */
 
+    /* Scheduler instrumentation. */
+    SYS_SCHEDSTAT,              /* Get scheduler statistics. */
+
+    /* Scheduling control. */
+    SYS_SETPRIORITY,            /* Set a process's priority. */
+    SYS_GETPRIORITY,            /* Get a process's priority. */
+    SYS_NICE,                   /* Change a process's nice value. */
+
+    /* Positioned and scatter-gather I/O. */
+    SYS_PREAD,                  /* Read from a file at an offset. */
+    SYS_PWRITE,                 /* Write to a file at an offset. */
+    SYS_READV,                  /* Read from a file into buffers. */
+    SYS_WRITEV,                 /* Write buffers to a file. */
+
+    /* Batched I/O. */
+    SYS_IORING_SETUP,           /* Register I/O rings. */
+    SYS_IORING_ENTER,           /* Carry out submitted I/O. */
+
     /* Number Of System calls */
     NUM_SYSCALL
   };
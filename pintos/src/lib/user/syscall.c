@@ -1,31 +1,47 @@
 #include <syscall.h>
 #include "../syscall-nr.h"
 
+/* Enters the kernel once the system call number and arguments
+   are on the stack, followed by the registers other than %eax
+   that doing so clobbers.  Built with SYSCALL_SYSENTER this uses
+   SYSENTER, passing the stack pointer in %ecx and the address to
+   resume at in %edx (see userprog/syscall-entry.S), which is much
+   cheaper than the `int $0x30' interrupt gate but needs a CPU
+   that has it.  Pick it with "make SYSCALL_ENTRY=sysenter". */
+#ifdef SYSCALL_SYSENTER
+#define SYSCALL_TRAP "movl %%esp, %%ecx; movl $1f, %%edx; sysenter; 1: "
+#define SYSCALL_CLOBBERS "ecx", "edx", "memory"
+#else
+#define SYSCALL_TRAP "int $0x30; "
+#define SYSCALL_CLOBBERS "memory"
+#endif
+
 /* Invokes syscall NUMBER, passing no arguments, and returns the
    return value as an `int'. */
 #define syscall0(NUMBER)                                        \
         ({                                                      \
           int retval;                                           \
           asm volatile                                          \
-            ("pushl %[number]; int $0x30; addl $4, %%esp"       \
+            ("pushl %[number]; " SYSCALL_TRAP "addl $4, %%esp"  \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER)                          \
-               : "memory");                                     \
+               : SYSCALL_CLOBBERS);                             \
           retval;                                               \
         })
 
 /* Invokes syscall NUMBER, passing argument ARG0, and returns the
    return value as an `int'. */
-#define syscall1(NUMBER, ARG0)                                           \
-        ({                                                               \
-          int retval;                                                    \
-          asm volatile                                                   \
-            ("pushl %[arg0]; pushl %[number]; int $0x30; addl $8, %%esp" \
-               : "=a" (retval)                                           \
-               : [number] "i" (NUMBER),                                  \
-                 [arg0] "r" (ARG0)                                       \
-               : "memory");                                              \
-          retval;                                                        \
+#define syscall1(NUMBER, ARG0)                                  \
+        ({                                                      \
+          int retval;                                           \
+          asm volatile                                          \
+            ("pushl %[arg0]; pushl %[number]; "                 \
+             SYSCALL_TRAP "addl $8, %%esp"                      \
+               : "=a" (retval)                                  \
+               : [number] "i" (NUMBER),                         \
+                 [arg0] "r" (ARG0)                              \
+               : SYSCALL_CLOBBERS);                             \
+          retval;                                               \
         })
 
 /* Invokes syscall NUMBER, passing arguments ARG0 and ARG1, and
@@ -35,12 +51,12 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg1]; pushl %[arg0]; "                   \
-             "pushl %[number]; int $0x30; addl $12, %%esp"      \
+             "pushl %[number]; " SYSCALL_TRAP "addl $12, %%esp" \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
                  [arg0] "r" (ARG0),                             \
                  [arg1] "r" (ARG1)                              \
-               : "memory");                                     \
+               : SYSCALL_CLOBBERS);                             \
           retval;                                               \
         })
 
@@ -51,13 +67,13 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "    \
-             "pushl %[number]; int $0x30; addl $16, %%esp"      \
+             "pushl %[number]; " SYSCALL_TRAP "addl $16, %%esp" \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
                  [arg0] "r" (ARG0),                             \
                  [arg1] "r" (ARG1),                             \
                  [arg2] "r" (ARG2)                              \
-               : "memory");                                     \
+               : SYSCALL_CLOBBERS);                             \
           retval;                                               \
         })
 
@@ -68,14 +84,14 @@
           int retval;                                                           \
           asm volatile                                                          \
             ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "     \
-             "pushl %[number]; int $0x30; addl $20, %%esp"                      \
+             "pushl %[number]; " SYSCALL_TRAP "addl $20, %%esp"                 \
                : "=a" (retval)                                                  \
                : [number] "i" (NUMBER),                                         \
                  [arg0] "r" (ARG0),                                             \
                  [arg1] "r" (ARG1),                                             \
                  [arg2] "r" (ARG2),                                             \
                  [arg3] "r" (ARG3)                                              \
-               : "memory");                                                     \
+               : SYSCALL_CLOBBERS);                                             \
           retval;                                                               \
         })
 void
@@ -170,6 +186,42 @@ sum_of_four_integers(int a, int b, int c, int d)
   return syscall4 (SYS_SUM, a, b, c, d);
 }
 
+int
+pread (int fd, void *buffer, unsigned size, unsigned offset) 
+{
+  return syscall4 (SYS_PREAD, fd, buffer, size, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned size, unsigned offset) 
+{
+  return syscall4 (SYS_PWRITE, fd, buffer, size, offset);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt) 
+{
+  return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt) 
+{
+  return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+bool
+ioring_setup (struct ioring *ring) 
+{
+  return syscall1 (SYS_IORING_SETUP, ring);
+}
+
+int
+ioring_enter (void) 
+{
+  return syscall0 (SYS_IORING_ENTER);
+}
+
 mapid_t
 mmap (int fd, void *addr)
 {
@@ -211,3 +263,27 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+bool
+schedstat (struct schedstat *stats) 
+{
+  return syscall1 (SYS_SCHEDSTAT, stats);
+}
+
+bool
+setpriority (pid_t pid, int priority) 
+{
+  return syscall2 (SYS_SETPRIORITY, pid, priority);
+}
+
+int
+getpriority (pid_t pid) 
+{
+  return syscall1 (SYS_GETPRIORITY, pid);
+}
+
+int
+nice (pid_t pid, int increment) 
+{
+  return syscall2 (SYS_NICE, pid, increment);
+}
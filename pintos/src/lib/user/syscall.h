@@ -2,7 +2,10 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <debug.h>
+#include <ioring.h>
+#include <schedstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -12,6 +15,24 @@ typedef int pid_t;
 typedef int mapid_t;
 #define MAP_FAILED ((mapid_t) -1)
 
+/* Range of priorities for setpriority(). */
+#define PRIO_MIN 0              /* Lowest priority. */
+#define PRIO_MAX 63             /* Highest priority. */
+
+/* Range of nice values, and nice()'s return value on failure. */
+#define NICE_MIN (-20)          /* Most favored. */
+#define NICE_MAX 20             /* Least favored. */
+#define NICE_ERROR (-128)
+
+/* One buffer for readv() and writev(), which take at most
+   IOV_MAX of them. */
+struct iovec
+  {
+    void *iov_base;             /* Start of buffer. */
+    size_t iov_len;             /* Size of buffer in bytes. */
+  };
+#define IOV_MAX 32
+
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
@@ -35,6 +56,12 @@ unsigned tell (int fd);
 void close (int fd);
 int fibonacci (int n);
 int sum_of_four_integers(int a, int b, int c, int d);
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+bool ioring_setup (struct ioring *);
+int ioring_enter (void);
 
 /* Project 3 and optionally project 4. */
 mapid_t mmap (int fd, void *addr);
@@ -47,4 +74,12 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Scheduler instrumentation. */
+bool schedstat (struct schedstat *);
+
+/* Scheduling control.  PID 0 means the calling process. */
+bool setpriority (pid_t, int priority);
+int getpriority (pid_t);
+int nice (pid_t, int increment);
+
 #endif /* lib/user/syscall.h */
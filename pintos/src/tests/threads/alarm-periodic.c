@@ -0,0 +1,49 @@
+/* Arms a periodic kernel alarm and a one-shot alarm that is
+   cancelled before it goes off, sleeps across several periods,
+   and checks that the periodic alarm went off once per period
+   and the cancelled one never did. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static alarm_func count_alarm;
+
+void
+test_alarm_periodic (void) 
+{
+  struct alarm periodic, cancelled;
+  int periodic_cnt = 0, cancelled_cnt = 0;
+  int64_t start;
+
+  alarm_init (&periodic, count_alarm, &periodic_cnt);
+  alarm_init (&cancelled, count_alarm, &cancelled_cnt);
+
+  start = timer_ticks ();
+  alarm_set (&periodic, start + 10, 10);
+  alarm_set (&cancelled, start + 20, 0);
+  timer_sleep (5);
+  alarm_cancel (&cancelled);
+
+  msg ("Periodic alarm armed, pending: %s.",
+       alarm_pending (&periodic) ? "yes" : "no");
+  msg ("One-shot alarm cancelled, pending: %s.",
+       alarm_pending (&cancelled) ? "yes" : "no");
+
+  /* Sleep until halfway between the 10th and 11th periods. */
+  timer_sleep (start + 105 - timer_ticks ());
+  alarm_cancel (&periodic);
+
+  msg ("Periodic alarm went off %d times.", periodic_cnt);
+  msg ("Cancelled alarm went off %d times.", cancelled_cnt);
+}
+
+/* Alarm function: increments the counter that COUNT_ points
+   to. */
+static void
+count_alarm (void *count_) 
+{
+  int *count = count_;
+  (*count)++;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-periodic) begin
+(alarm-periodic) Periodic alarm armed, pending: yes.
+(alarm-periodic) One-shot alarm cancelled, pending: no.
+(alarm-periodic) Periodic alarm went off 10 times.
+(alarm-periodic) Cancelled alarm went off 0 times.
+(alarm-periodic) end
+EOF
+pass;
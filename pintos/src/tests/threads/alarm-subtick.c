@@ -0,0 +1,54 @@
+/* Sleeps for less than a tick with timer_usleep() several
+   times, while a lower-priority thread counts in a loop.  The
+   sleeps must block rather than busy-wait, so the counter must
+   advance, and each must last at least as long as asked
+   according to timer_now_ns(). */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SLEEPS 10
+#define SLEEP_US 500
+
+static thread_func counter;
+static volatile int count;
+static volatile bool done;
+
+void
+test_alarm_subtick (void) 
+{
+  int64_t before, after, last = timer_now_ns ();
+  bool long_enough = true, monotonic = true;
+  int i;
+
+  thread_create ("counter", PRI_DEFAULT - 1, counter, NULL);
+
+  for (i = 0; i < SLEEPS; i++) 
+    {
+      before = timer_now_ns ();
+      timer_usleep (SLEEP_US);
+      after = timer_now_ns ();
+      if (after - before < SLEEP_US * 1000)
+        long_enough = false;
+      if (before < last || after < before)
+        monotonic = false;
+      last = after;
+    }
+  done = true;
+
+  msg ("Every sleep lasted at least %d us: %s.", SLEEP_US,
+       long_enough ? "yes" : "no");
+  msg ("Clock never went backward: %s.", monotonic ? "yes" : "no");
+  msg ("Lower-priority thread ran during the sleeps: %s.",
+       count > 0 ? "yes" : "no");
+}
+
+/* Counts until the test is done. */
+static void
+counter (void *aux UNUSED) 
+{
+  while (!done)
+    count++;
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-subtick) begin
+(alarm-subtick) Every sleep lasted at least 500 us: yes.
+(alarm-subtick) Clock never went backward: yes.
+(alarm-subtick) Lower-priority thread ran during the sleeps: yes.
+(alarm-subtick) end
+EOF
+pass;
@@ -0,0 +1,92 @@
+/* Queues work items to the system workqueues from a thread, from
+   a timer alarm (that is, from interrupt context) and with a
+   delay, cancels one delayed item, and checks that each item ran
+   once, in order, and no earlier than its delay. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+#define DELAY 10
+
+static work_func record_work;
+static work_func delayed_work_func;
+static alarm_func queue_from_alarm;
+
+static char order[8];
+static int order_cnt;
+static int64_t delayed_ran_at;
+static int cancelled_cnt;
+
+static struct work items[3];
+static struct work irq_item, delayed_item, cancelled_item;
+
+void
+test_alarm_workqueue (void) 
+{
+  struct alarm alarm;
+  int64_t start;
+  int i;
+
+  /* Outrank the normal-priority worker, so that nothing runs
+     until we sleep. */
+  thread_set_priority (PRI_DEFAULT + 1);
+
+  for (i = 0; i < 3; i++)
+    work_init (&items[i], record_work, (void *) ('A' + i));
+  work_init (&irq_item, record_work, (void *) 'I');
+  work_init (&delayed_item, delayed_work_func, NULL);
+  work_init (&cancelled_item, delayed_work_func, &cancelled_cnt);
+  alarm_init (&alarm, queue_from_alarm, &irq_item);
+
+  for (i = 0; i < 3; i++)
+    work_queue (&wq_normal, &items[i]);
+  msg ("Queueing a pending item again: %s.",
+       work_queue (&wq_normal, &items[0]) ? "queued" : "refused");
+
+  start = timer_ticks ();
+  work_queue_delayed (&wq_normal, &delayed_item, DELAY);
+  work_queue_delayed (&wq_normal, &cancelled_item, DELAY);
+  msg ("Cancelling a delayed item: %s.",
+       work_cancel_delayed (&cancelled_item) ? "cancelled" : "too late");
+  alarm_set (&alarm, start + 2, 0);
+
+  timer_sleep (2 * DELAY);
+
+  order[order_cnt] = '\0';
+  msg ("Items ran in order: %s.", order);
+  msg ("Delayed item waited at least %d ticks: %s.", DELAY,
+       delayed_ran_at - start >= DELAY ? "yes" : "no");
+  msg ("Cancelled item ran %d times.", cancelled_cnt);
+
+  thread_set_priority (PRI_DEFAULT);
+}
+
+/* Work function: appends the character in W's aux to ORDER. */
+static void
+record_work (struct work *w) 
+{
+  order[order_cnt++] = (char) (int) w->aux;
+}
+
+/* Work function for the delayed items: records when it ran, and
+   counts runs in the counter W's aux points to, if any. */
+static void
+delayed_work_func (struct work *w) 
+{
+  int *cnt = w->aux;
+
+  delayed_ran_at = timer_ticks ();
+  if (cnt != NULL)
+    (*cnt)++;
+}
+
+/* Alarm function: queues work item W_ from the timer
+   interrupt. */
+static void
+queue_from_alarm (void *w_) 
+{
+  work_queue (&wq_high, w_);
+}
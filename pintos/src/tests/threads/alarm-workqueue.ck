@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-workqueue) begin
+(alarm-workqueue) Queueing a pending item again: refused.
+(alarm-workqueue) Cancelling a delayed item: cancelled.
+(alarm-workqueue) Items ran in order: ABCI.
+(alarm-workqueue) Delayed item waited at least 10 ticks: yes.
+(alarm-workqueue) Cancelled item ran 0 times.
+(alarm-workqueue) end
+EOF
+pass;
@@ -0,0 +1,113 @@
+/* Runs three periodic EDF threads, reserving 60% of the CPU
+   between them, beside two CPU-bound normal threads, one of them
+   at the highest priority.  Checks that admission control turns
+   away a thread that would push the EDF threads past 100% of the
+   CPU, and that every job of every EDF thread meets its
+   deadline.
+
+   Also run as edf-mixed-stride, with the normal threads under
+   the stride scheduler. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define EDF_CNT 3
+#define JOB_CNT 8
+
+struct edf_info 
+  {
+    int64_t period;             /* Ticks between releases. */
+    int64_t budget;             /* Ticks of CPU per period. */
+    bool admitted;              /* Admitted to the EDF class? */
+    int jobs;                   /* Jobs completed. */
+    int misses;                 /* Deadlines missed. */
+  };
+
+static thread_func edf_thread, load_thread;
+static void spin_ticks (int64_t cnt);
+
+static int64_t load_end;
+
+void
+test_edf_mixed (void) 
+{
+  static struct edf_info info[EDF_CNT] = {
+    {10, 2, false, 0, 0},
+    {20, 4, false, 0, 0},
+    {40, 8, false, 0, 0},
+  };
+  int i;
+
+  /* Each EDF thread joins the EDF class as soon as it runs.
+     Under priority scheduling it outranks us and so runs when it
+     is created; under stride scheduling it might not, so sleep
+     to let them all run. */
+  for (i = 0; i < EDF_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "edf %d", i);
+      thread_create (name, PRI_MAX, edf_thread, &info[i]);
+    }
+  timer_sleep (1);
+
+  /* That leaves 40% of the CPU unreserved. */
+  msg ("Admitting a thread needing 50%% of the CPU: %s.",
+       thread_set_deadline (10, 5) ? "admitted" : "rejected");
+
+  /* Load the CPU until after the last job's deadline, and sleep
+     until then too, since under stride scheduling "load-max" does
+     not keep us from running. */
+  load_end = timer_ticks () + JOB_CNT * 40 + 20;
+  thread_create ("load", PRI_DEFAULT, load_thread, NULL);
+  thread_create ("load-max", PRI_MAX, load_thread, NULL);
+
+  timer_sleep (load_end - timer_ticks ());
+  for (i = 0; i < EDF_CNT; i++)
+    msg ("EDF thread %d: admitted %s, %d jobs, %d deadline misses.", i,
+         info[i].admitted ? "yes" : "no", info[i].jobs, info[i].misses);
+}
+
+/* Joins the EDF class with the period and budget in INFO_, then
+   runs JOB_CNT jobs of one tick less than the budget each. */
+static void
+edf_thread (void *info_) 
+{
+  struct edf_info *info = info_;
+
+  info->admitted = thread_set_deadline (info->period, info->budget);
+  if (!info->admitted)
+    return;
+  for (info->jobs = 0; info->jobs < JOB_CNT; info->jobs++) 
+    {
+      spin_ticks (info->budget - 1);
+      thread_edf_next_period ();
+    }
+  info->misses = thread_edf_misses ();
+  thread_set_deadline (0, 0);
+}
+
+/* Spins until load_end. */
+static void
+load_thread (void *aux UNUSED) 
+{
+  while (timer_ticks () < load_end)
+    continue;
+}
+
+/* Spins until the timer has ticked CNT times while we ran. */
+static void
+spin_ticks (int64_t cnt) 
+{
+  int64_t last = timer_ticks ();
+
+  while (cnt > 0) 
+    {
+      int64_t now = timer_ticks ();
+      if (now != last)
+        cnt--;
+      last = now;
+    }
+}
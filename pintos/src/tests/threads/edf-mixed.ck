@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-mixed) begin
+(edf-mixed) Admitting a thread needing 50% of the CPU: rejected.
+(edf-mixed) EDF thread 0: admitted yes, 8 jobs, 0 deadline misses.
+(edf-mixed) EDF thread 1: admitted yes, 8 jobs, 0 deadline misses.
+(edf-mixed) EDF thread 2: admitted yes, 8 jobs, 0 deadline misses.
+(edf-mixed) end
+EOF
+pass;
@@ -0,0 +1,111 @@
+/* Measures the worst-case time a high-priority thread waits for
+   a lock held by a low-priority thread while several
+   medium-priority threads compete for the CPU.
+
+   Each round, a low-priority thread acquires the lock and then
+   needs CS_TICKS ticks of CPU time before it releases it.  The
+   main thread, at the highest priority, creates HOG_CNT
+   medium-priority threads that spin for HOG_TICKS and then
+   tries to acquire the lock.  With priority donation the low
+   thread runs ahead of the hogs and the wait is about CS_TICKS;
+   without it the main thread waits behind the hogs for about
+   HOG_TICKS. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define ROUNDS 5
+#define HOG_CNT 4
+#define CS_TICKS 4
+#define HOG_TICKS 100
+#define MAX_WAIT (CS_TICKS + 3)
+
+#define LOW_PRI (PRI_DEFAULT - 10)
+#define MED_PRI (PRI_DEFAULT - 5)
+
+static struct lock lock;
+static struct semaphore held;
+static struct semaphore exited;
+
+static thread_func low_thread_func;
+static thread_func hog_thread_func;
+static void burn_ticks (int ticks);
+
+void
+test_priority_donate_latency (void) 
+{
+  int64_t worst = 0;
+  int round, i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  sema_init (&held, 0);
+  sema_init (&exited, 0);
+
+  for (round = 0; round < ROUNDS; round++) 
+    {
+      int64_t start, wait;
+
+      thread_create ("low", LOW_PRI, low_thread_func, NULL);
+      sema_down (&held);
+
+      for (i = 0; i < HOG_CNT; i++) 
+        thread_create ("hog", MED_PRI, hog_thread_func, NULL);
+
+      start = timer_ticks ();
+      lock_acquire (&lock);
+      wait = timer_ticks () - start;
+      lock_release (&lock);
+      if (wait > worst)
+        worst = wait;
+
+      for (i = 0; i < HOG_CNT + 1; i++)
+        sema_down (&exited);
+    }
+
+  msg ("worst-case wait: %lld ticks over %d rounds", worst, ROUNDS);
+  if (worst > MAX_WAIT)
+    fail ("worst-case wait exceeds %d ticks", MAX_WAIT);
+  pass ();
+}
+
+static void
+low_thread_func (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  sema_up (&held);
+  burn_ticks (CS_TICKS);
+  lock_release (&lock);
+  sema_up (&exited);
+}
+
+static void
+hog_thread_func (void *aux UNUSED) 
+{
+  burn_ticks (HOG_TICKS);
+  sema_up (&exited);
+}
+
+/* Spins until TICKS timer ticks have been observed while this
+   thread was running, approximating TICKS ticks of CPU time. */
+static void
+burn_ticks (int ticks) 
+{
+  int64_t last = timer_ticks ();
+
+  while (ticks > 0) 
+    {
+      int64_t now = timer_ticks ();
+      if (now != last) 
+        {
+          last = now;
+          ticks--;
+        }
+    }
+}
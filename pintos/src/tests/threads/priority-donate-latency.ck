@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing worst-case wait in output"
+  unless grep (/^\(priority-donate-latency\) worst-case wait: \d+ ticks/,
+	       @output);
+fail "missing PASS in output"
+  unless grep ($_ eq '(priority-donate-latency) PASS', @output);
+
+pass;
@@ -0,0 +1,54 @@
+/* The main thread acquires a lock in hand-off mode and creates a
+   lower-priority thread that blocks acquiring it.  When the main
+   thread releases the lock, it must pass straight to the waiter,
+   so the main thread's immediate attempt to take it back fails
+   even though the waiter has not run yet.  The main thread then
+   blocks on the lock, donating its priority to the waiter, which
+   finishes and hands the lock back. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func waiter_thread_func;
+
+void
+test_priority_handoff (void) 
+{
+  struct lock lock;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&lock);
+  lock_set_handoff (&lock, true);
+  lock_acquire (&lock);
+  thread_create ("waiter", PRI_DEFAULT - 1, waiter_thread_func, &lock);
+  timer_sleep (1);
+  msg ("Waiter is blocked on the lock.");
+
+  lock_release (&lock);
+  if (lock_try_acquire (&lock))
+    fail ("Main reacquired the lock ahead of the waiter.");
+  msg ("Lock was handed off to the waiter.");
+
+  lock_acquire (&lock);
+  msg ("Main acquired the lock.");
+  lock_release (&lock);
+}
+
+static void
+waiter_thread_func (void *lock_) 
+{
+  struct lock *lock = lock_;
+
+  lock_acquire (lock);
+  msg ("Waiter acquired the lock with priority %d.", thread_get_priority ());
+  lock_release (lock);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-handoff) begin
+(priority-handoff) Waiter is blocked on the lock.
+(priority-handoff) Lock was handed off to the waiter.
+(priority-handoff) Waiter acquired the lock with priority 31.
+(priority-handoff) Main acquired the lock.
+(priority-handoff) end
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* The main thread holds a readers-writer lock exclusive while a
+   reader, a writer and a higher-priority reader, created in that
+   order, block on it.  When the main thread releases it, the
+   writer must go first even though a reader outranks it, since
+   the lock prefers writers.  When the writer releases it, both
+   readers get in, in priority order. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_thread_func;
+static thread_func writer_thread_func;
+
+static struct rwlock rwlock;
+
+void
+test_priority_rwlock (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_exclusive (&rwlock);
+  thread_create ("reader 1", PRI_DEFAULT + 1, reader_thread_func, NULL);
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread_func, NULL);
+  thread_create ("reader 2", PRI_DEFAULT + 3, reader_thread_func, NULL);
+  msg ("All three threads are waiting.");
+  rwlock_release_exclusive (&rwlock);
+  msg ("Main thread done.");
+}
+
+static void
+reader_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_shared (&rwlock);
+  msg ("%s acquired the lock shared.", thread_name ());
+  rwlock_release_shared (&rwlock);
+}
+
+static void
+writer_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_exclusive (&rwlock);
+  msg ("%s acquired the lock exclusive.", thread_name ());
+  rwlock_release_exclusive (&rwlock);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-rwlock) begin
+(priority-rwlock) All three threads are waiting.
+(priority-rwlock) writer acquired the lock exclusive.
+(priority-rwlock) reader 2 acquired the lock shared.
+(priority-rwlock) reader 1 acquired the lock shared.
+(priority-rwlock) Main thread done.
+(priority-rwlock) end
+EOF
+pass;
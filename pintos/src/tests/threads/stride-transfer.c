@@ -0,0 +1,88 @@
+/* Checks that a thread blocked on a lock lends its stride
+   tickets to the lock's holder.
+
+   A "holder" thread with 100 tickets takes a lock and spins
+   while a "spinner" thread, also with 100 tickets, spins beside
+   it.  A "waiter" thread with 800 tickets then blocks on the
+   lock.  While it waits, the holder should run with 900 tickets
+   and so get about 9 times the CPU time of the spinner.  Without
+   the loan the two would split the CPU evenly. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPIN_START (1 * TIMER_FREQ)     /* When counting starts. */
+#define SPIN_END (6 * TIMER_FREQ)       /* When counting stops. */
+
+static struct lock lock;
+static int64_t start_time;
+static int holder_ticks, spinner_ticks;
+
+static thread_func holder_thread, spinner_thread, waiter_thread;
+static int spin (void);
+
+void
+test_stride_transfer (void) 
+{
+  ASSERT (thread_stride);
+
+  lock_init (&lock);
+  start_time = timer_ticks ();
+  thread_create ("holder", PRI_DEFAULT, holder_thread, NULL);
+  thread_create ("spinner", PRI_DEFAULT, spinner_thread, NULL);
+  thread_create ("waiter", PRI_DEFAULT, waiter_thread, NULL);
+
+  timer_sleep (SPIN_END + TIMER_FREQ);
+  msg ("Holder got at least 4 times the spinner's ticks: %s.",
+       holder_ticks >= 4 * spinner_ticks ? "yes" : "no");
+}
+
+static void
+holder_thread (void *aux UNUSED) 
+{
+  thread_set_tickets (100);
+  lock_acquire (&lock);
+  holder_ticks = spin ();
+  lock_release (&lock);
+}
+
+static void
+spinner_thread (void *aux UNUSED) 
+{
+  thread_set_tickets (100);
+  spinner_ticks = spin ();
+}
+
+static void
+waiter_thread (void *aux UNUSED) 
+{
+  thread_set_tickets (800);
+  timer_sleep (SPIN_START / 2);
+  lock_acquire (&lock);
+  lock_release (&lock);
+}
+
+/* Spins from SPIN_START to SPIN_END ticks after the test
+   started, returning the number of ticks in between that the
+   calling thread saw. */
+static int
+spin (void) 
+{
+  int64_t last_time = 0;
+  int cnt = 0;
+
+  while (timer_elapsed (start_time) < SPIN_START)
+    continue;
+  while (timer_elapsed (start_time) < SPIN_END) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        cnt++;
+      last_time = cur_time;
+    }
+  return cnt;
+}
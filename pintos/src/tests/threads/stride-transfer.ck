@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stride-transfer) begin
+(stride-transfer) Holder got at least 4 times the spinner's ticks: yes.
+(stride-transfer) end
+EOF
+pass;
@@ -17,6 +17,9 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-periodic", test_alarm_periodic},
+    {"alarm-workqueue", test_alarm_workqueue},
+    {"alarm-subtick", test_alarm_subtick},
     {"priority-change", test_priority_change},
     {"priority-change-2", test_priority_change_2},
     {"priority-donate-one", test_priority_donate_one},
@@ -26,6 +29,9 @@ static const struct test tests[] =
     {"priority-donate-sema", test_priority_donate_sema},
     {"priority-donate-lower", test_priority_donate_lower},
     {"priority-donate-chain", test_priority_donate_chain},
+    {"priority-donate-latency", test_priority_donate_latency},
+    {"priority-handoff", test_priority_handoff},
+    {"priority-rwlock", test_priority_rwlock},
     {"priority-fifo", test_priority_fifo},
     {"priority-lifo", test_priority_lifo},
     {"priority-preempt", test_priority_preempt},
@@ -41,6 +47,11 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"stride-fair-2", test_stride_fair_2},
+    {"stride-ratio", test_stride_ratio},
+    {"stride-transfer", test_stride_transfer},
+    {"edf-mixed", test_edf_mixed},
+    {"edf-mixed-stride", test_edf_mixed},
   };
 
 static const char *test_name;
@@ -0,0 +1,53 @@
+/* Child process run by the sched-perm and sched-mlfqs tests.
+   Checks that a process without privilege may lower but not
+   raise its priority, may raise but not lower its nice value,
+   and may not touch its parent, whose pid is argv[1].  If
+   argv[2] is "mlfqs", checks instead that setpriority() always
+   fails. */
+
+#include <string.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-sched";
+
+int
+main (int argc, char *argv[]) 
+{
+  pid_t parent;
+  bool mlfqs;
+  int priority, niceness;
+
+  if (argc < 2)
+    fail ("missing parent pid");
+  parent = atoi (argv[1]);
+  mlfqs = argc > 2 && !strcmp (argv[2], "mlfqs");
+
+  priority = getpriority (0);
+  if (!mlfqs) 
+    {
+      CHECK (priority > PRIO_MIN, "get own priority");
+      CHECK (setpriority (0, priority - 1), "lower own priority");
+      CHECK (getpriority (0) == priority - 1, "priority lowered");
+      CHECK (!setpriority (0, priority), "raise own priority");
+      CHECK (getpriority (0) == priority - 1, "priority unchanged");
+    }
+  else 
+    {
+      CHECK (priority != -1, "get own priority");
+      CHECK (!setpriority (0, PRIO_MIN), "setpriority under mlfqs");
+    }
+
+  niceness = nice (0, 0);
+  CHECK (niceness != NICE_ERROR && niceness < NICE_MAX, "get own nice value");
+  CHECK (nice (0, 1) == niceness + 1, "raise own nice value");
+  CHECK (nice (0, -1) == NICE_ERROR, "lower own nice value");
+  CHECK (nice (0, 0) == niceness + 1, "nice value unchanged");
+
+  CHECK (!setpriority (parent, PRIO_MIN), "setpriority on parent");
+  CHECK (getpriority (parent) == -1, "getpriority on parent");
+  CHECK (nice (parent, 1) == NICE_ERROR, "nice on parent");
+
+  return 0;
+}
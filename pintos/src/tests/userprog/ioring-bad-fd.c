@@ -0,0 +1,55 @@
+/* Submits I/O ring operations on bad file descriptors and bad
+   file names.  Each must fail with -1 without affecting the
+   others. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+
+/* Submits operation OP on FD with BUF, LEN and OFFSET, tagged
+   with USER_DATA. */
+static void
+submit (enum ioring_op op, int fd, void *buf, unsigned len, int offset,
+        unsigned user_data) 
+{
+  struct ioring_sqe *sqe = &ring.sq[ring.sq_tail % IORING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int handle, i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (ioring_setup (&ring), "ioring_setup");
+
+  submit (IORING_OP_READ, 1234, buf, sizeof buf, -1, 0);
+  submit (IORING_OP_WRITE, 1234, buf, sizeof buf, 0, 1);
+  submit (IORING_OP_CLOSE, 1234, NULL, 0, 0, 2);
+  submit (IORING_OP_OPEN, -1, "no-such-file", 0, 0, 3);
+  submit (IORING_OP_OPEN, -1, "", 0, 0, 4);
+  submit (IORING_OP_OPEN, -1, (char *) 0xc0100000, 0, 0, 5);
+  submit (IORING_OP_READ, handle, buf, sizeof buf, 10, 6);
+  CHECK (ioring_enter () == 7, "ioring_enter with 7 operations");
+
+  for (i = 0; i < 6; i++)
+    if (ring.cq[i].user_data != (unsigned) i || ring.cq[i].result != -1)
+      fail ("completion %d has user_data %u and result %d", i,
+            (unsigned) ring.cq[i].user_data, (int) ring.cq[i].result);
+  msg ("bad operations failed");
+
+  CHECK (ring.cq[6].result == sizeof buf, "good read succeeded");
+  compare_bytes (buf, sample + 10, sizeof buf, 10, "sample.txt");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ioring-bad-fd) begin
+(ioring-bad-fd) open "sample.txt"
+(ioring-bad-fd) ioring_setup
+(ioring-bad-fd) ioring_enter with 7 operations
+(ioring-bad-fd) bad operations failed
+(ioring-bad-fd) good read succeeded
+(ioring-bad-fd) end
+ioring-bad-fd: exit(0)
+EOF
+pass;
@@ -0,0 +1,27 @@
+/* Submits an I/O ring read into an invalid buffer.
+   The process must be terminated with -1 exit code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+
+void
+test_main (void) 
+{
+  struct ioring_sqe *sqe = &ring.sq[0];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (ioring_setup (&ring), "ioring_setup");
+
+  sqe->op = IORING_OP_READ;
+  sqe->fd = handle;
+  sqe->buf = (char *) 0xc0100000;
+  sqe->len = 123;
+  sqe->offset = -1;
+  ring.sq_tail++;
+  ioring_enter ();
+  fail ("should not have survived ioring_enter()");
+}
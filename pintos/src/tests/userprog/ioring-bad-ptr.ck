@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ioring-bad-ptr) begin
+(ioring-bad-ptr) open "sample.txt"
+(ioring-bad-ptr) ioring_setup
+ioring-bad-ptr: exit(-1)
+EOF
+pass;
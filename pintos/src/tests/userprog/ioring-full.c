@@ -0,0 +1,58 @@
+/* Checks that ioring_enter() stops taking submissions when the
+   completion ring is full and picks up where it left off once
+   completions have been consumed. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+
+/* Submits a no-op tagged with USER_DATA. */
+static void
+submit_nop (unsigned user_data) 
+{
+  struct ioring_sqe *sqe = &ring.sq[ring.sq_tail % IORING_ENTRIES];
+
+  sqe->op = IORING_OP_NOP;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+void
+test_main (void) 
+{
+  unsigned i;
+
+  CHECK (ioring_setup (&ring), "ioring_setup");
+
+  for (i = 0; i < IORING_ENTRIES; i++)
+    submit_nop (i);
+  CHECK (ioring_enter () == IORING_ENTRIES, "fill completion ring");
+
+  for (i = IORING_ENTRIES; i < IORING_ENTRIES + 10; i++)
+    submit_nop (i);
+  CHECK (ioring_enter () == 0, "ioring_enter with completion ring full");
+  CHECK (ring.sq_head == IORING_ENTRIES && ring.cq_tail == IORING_ENTRIES,
+         "submissions left pending");
+
+  ring.cq_head += 4;
+  CHECK (ioring_enter () == 4, "ioring_enter with room for 4");
+  CHECK (ring.sq_head == IORING_ENTRIES + 4
+         && ring.cq_tail == IORING_ENTRIES + 4,
+         "sq_head and cq_tail advanced by 4");
+
+  ring.cq_head = ring.cq_tail;
+  CHECK (ioring_enter () == 6, "ioring_enter with room for the rest");
+  CHECK (ring.sq_head == ring.sq_tail
+         && ring.cq_tail == IORING_ENTRIES + 10,
+         "submission ring drained");
+
+  for (i = IORING_ENTRIES; i < IORING_ENTRIES + 10; i++)
+    if (ring.cq[i % IORING_ENTRIES].user_data != i)
+      fail ("completion %u has user_data %u", i,
+            (unsigned) ring.cq[i % IORING_ENTRIES].user_data);
+  msg ("completions posted in order");
+
+  CHECK (ioring_enter () == 0, "ioring_enter with nothing submitted");
+}
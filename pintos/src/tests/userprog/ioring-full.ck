@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ioring-full) begin
+(ioring-full) ioring_setup
+(ioring-full) fill completion ring
+(ioring-full) ioring_enter with completion ring full
+(ioring-full) submissions left pending
+(ioring-full) ioring_enter with room for 4
+(ioring-full) sq_head and cq_tail advanced by 4
+(ioring-full) ioring_enter with room for the rest
+(ioring-full) submission ring drained
+(ioring-full) completions posted in order
+(ioring-full) ioring_enter with nothing submitted
+(ioring-full) end
+ioring-full: exit(0)
+EOF
+pass;
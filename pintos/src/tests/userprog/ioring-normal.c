@@ -0,0 +1,72 @@
+/* Submits a batch mixing every kind of I/O ring operation and
+   checks that one ioring_enter() carries them all out, posting
+   the results in order with their user_data. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+
+/* Submits operation OP on FD with BUF, LEN and OFFSET, tagged
+   with USER_DATA. */
+static void
+submit (enum ioring_op op, int fd, void *buf, unsigned len, int offset,
+        unsigned user_data) 
+{
+  struct ioring_sqe *sqe = &ring.sq[ring.sq_tail % IORING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+void
+test_main (void) 
+{
+  static char buf[sizeof sample];
+  size_t size = sizeof sample - 1;
+  int read_fd, write_fd, close_fd, open_fd;
+  int i;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((read_fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((write_fd = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK ((close_fd = open ("sample.txt")) > 1, "open \"sample.txt\" again");
+  CHECK (ioring_setup (&ring), "ioring_setup");
+
+  submit (IORING_OP_OPEN, -1, "sample.txt", 0, 0, 100);
+  submit (IORING_OP_READ, read_fd, buf, size, -1, 101);
+  submit (IORING_OP_WRITE, write_fd, sample, size, 0, 102);
+  submit (IORING_OP_CLOSE, close_fd, NULL, 0, 0, 103);
+  submit (IORING_OP_NOP, -1, NULL, 0, 0, 104);
+  CHECK (ioring_enter () == 5, "ioring_enter with 5 operations");
+
+  if (ring.sq_head != 5 || ring.cq_tail != 5)
+    fail ("sq_head is %u and cq_tail is %u instead of 5",
+          (unsigned) ring.sq_head, (unsigned) ring.cq_tail);
+  for (i = 0; i < 5; i++)
+    if (ring.cq[i].user_data != 100u + i)
+      fail ("completion %d has user_data %u instead of %d",
+            i, (unsigned) ring.cq[i].user_data, 100 + i);
+  msg ("completions posted in order");
+
+  open_fd = ring.cq[0].result;
+  CHECK (open_fd > 1, "open through ring");
+  CHECK (filesize (open_fd) == (int) size, "filesize of opened file");
+  CHECK (ring.cq[1].result == (int) size, "read through ring");
+  compare_bytes (buf, sample, size, 0, "sample.txt");
+  CHECK (tell (read_fd) == size, "read advanced file position");
+  CHECK (ring.cq[2].result == (int) size, "write through ring");
+  CHECK (tell (write_fd) == 0, "write at offset kept file position");
+  CHECK (ring.cq[3].result == 0, "close through ring");
+  CHECK (filesize (close_fd) == -1, "closed file is gone");
+  CHECK (ring.cq[4].result == 0, "nop through ring");
+
+  check_file_handle (write_fd, "test.txt", sample, size);
+}
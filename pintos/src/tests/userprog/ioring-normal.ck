@@ -0,0 +1,27 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ioring-normal) begin
+(ioring-normal) create "test.txt"
+(ioring-normal) open "sample.txt"
+(ioring-normal) open "test.txt"
+(ioring-normal) open "sample.txt" again
+(ioring-normal) ioring_setup
+(ioring-normal) ioring_enter with 5 operations
+(ioring-normal) completions posted in order
+(ioring-normal) open through ring
+(ioring-normal) filesize of opened file
+(ioring-normal) read through ring
+(ioring-normal) read advanced file position
+(ioring-normal) write through ring
+(ioring-normal) write at offset kept file position
+(ioring-normal) close through ring
+(ioring-normal) closed file is gone
+(ioring-normal) nop through ring
+(ioring-normal) verified contents of "test.txt"
+(ioring-normal) end
+ioring-normal: exit(0)
+EOF
+pass;
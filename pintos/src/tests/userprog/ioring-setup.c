@@ -0,0 +1,28 @@
+/* Checks that ioring_enter() fails until rings are registered,
+   that ioring_setup() rejects a ring that is not page-aligned or
+   not in user memory, and that it empties the rings. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ioring ring __attribute__ ((aligned (4096)));
+
+void
+test_main (void) 
+{
+  CHECK (ioring_enter () == -1, "ioring_enter before ioring_setup");
+  CHECK (!ioring_setup ((struct ioring *) ((char *) &ring + 8)),
+         "ioring_setup with unaligned ring");
+  CHECK (!ioring_setup ((struct ioring *) 0xc0000000),
+         "ioring_setup with kernel address");
+  CHECK (ioring_enter () == -1, "ioring_enter after failed ioring_setup");
+
+  ring.sq_head = ring.sq_tail = 5;
+  ring.cq_head = ring.cq_tail = 7;
+  CHECK (ioring_setup (&ring), "ioring_setup");
+  CHECK (ring.sq_head == 0 && ring.sq_tail == 0
+         && ring.cq_head == 0 && ring.cq_tail == 0,
+         "ioring_setup emptied the rings");
+  CHECK (ioring_enter () == 0, "ioring_enter with nothing submitted");
+}
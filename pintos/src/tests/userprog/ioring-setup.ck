@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ioring-setup) begin
+(ioring-setup) ioring_enter before ioring_setup
+(ioring-setup) ioring_setup with unaligned ring
+(ioring-setup) ioring_setup with kernel address
+(ioring-setup) ioring_enter after failed ioring_setup
+(ioring-setup) ioring_setup
+(ioring-setup) ioring_setup emptied the rings
+(ioring-setup) ioring_enter with nothing submitted
+(ioring-setup) end
+ioring-setup: exit(0)
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Opens "sample.txt" until open() fails, which must happen
+   cleanly once the file descriptor table has grown to its
+   largest size, well past its first page.  Then closes a low
+   descriptor and one in the second page of the table and
+   checks that the next open() reuses each of them. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Descriptors available to a process: the table holds at most
+   8 pages of 1024 entries, less stdin and stdout. */
+#define FD_CNT (8 * 1024 - 2)
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int cnt;
+  int fd;
+
+  for (cnt = 0; cnt <= FD_CNT; cnt++)
+    {
+      fd = open ("sample.txt");
+      if (fd < 0)
+        break;
+      if (fd != cnt + 2)
+        fail ("open() returned %d, expected %d", fd, cnt + 2);
+    }
+  if (cnt != FD_CNT)
+    fail ("opened %d files, expected %d", cnt, FD_CNT);
+  msg ("opened %d files", cnt);
+
+  CHECK (open ("sample.txt") == -1, "open at the cap fails again");
+  CHECK (read (FD_CNT + 1, buf, sizeof buf) == sizeof buf,
+         "read from the highest descriptor");
+
+  close (5);
+  CHECK (open ("sample.txt") == 5, "open reuses descriptor 5");
+  close (1500);
+  CHECK (open ("sample.txt") == 1500, "open reuses descriptor 1500");
+  CHECK (open ("sample.txt") == -1, "open with a full table fails");
+}
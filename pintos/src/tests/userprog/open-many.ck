@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-many) begin
+(open-many) opened 8190 files
+(open-many) open at the cap fails again
+(open-many) read from the highest descriptor
+(open-many) open reuses descriptor 5
+(open-many) open reuses descriptor 1500
+(open-many) open with a full table fails
+(open-many) end
+open-many: exit(0)
+EOF
+pass;
@@ -0,0 +1,40 @@
+/* Reads "sample.txt" at given offsets with pread(), which must
+   not move the file position, including a read that runs past
+   the end of the file and so must come up short. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[sizeof sample];
+  size_t size = sizeof sample - 1;
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  msg ("pread 20 bytes at offset 10");
+  byte_cnt = pread (handle, buf, 20, 10);
+  if (byte_cnt != 20)
+    fail ("pread() returned %d instead of 20", byte_cnt);
+  compare_bytes (buf, sample + 10, 20, 10, "sample.txt");
+  if (tell (handle) != 0)
+    fail ("file position is %u after pread() instead of 0",
+          tell (handle));
+
+  msg ("pread across end of file");
+  byte_cnt = pread (handle, buf, sizeof buf, size - 10);
+  if (byte_cnt != 10)
+    fail ("pread() returned %d instead of 10", byte_cnt);
+  compare_bytes (buf, sample + size - 10, 10, size - 10, "sample.txt");
+
+  msg ("pread beyond end of file");
+  byte_cnt = pread (handle, buf, sizeof buf, size + 100);
+  if (byte_cnt != 0)
+    fail ("pread() returned %d instead of 0", byte_cnt);
+
+  check_file_handle (handle, "sample.txt", sample, size);
+}
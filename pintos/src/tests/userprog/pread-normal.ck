@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-normal) begin
+(pread-normal) open "sample.txt"
+(pread-normal) pread 20 bytes at offset 10
+(pread-normal) pread across end of file
+(pread-normal) pread beyond end of file
+(pread-normal) verified contents of "sample.txt"
+(pread-normal) end
+pread-normal: exit(0)
+EOF
+pass;
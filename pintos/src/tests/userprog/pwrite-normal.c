@@ -0,0 +1,36 @@
+/* Writes "test.txt" back to front with pwrite(), which must not
+   move the file position, then reads it back from the start. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  size_t half = size / 2;
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  msg ("pwrite second half");
+  byte_cnt = pwrite (handle, sample + half, size - half, half);
+  if (byte_cnt != (int) (size - half))
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, size - half);
+  if (tell (handle) != 0)
+    fail ("file position is %u after pwrite() instead of 0",
+          tell (handle));
+
+  msg ("pwrite first half");
+  byte_cnt = pwrite (handle, sample, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, half);
+  if (tell (handle) != 0)
+    fail ("file position is %u after pwrite() instead of 0",
+          tell (handle));
+
+  check_file_handle (handle, "test.txt", sample, size);
+}
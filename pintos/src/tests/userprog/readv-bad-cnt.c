@@ -0,0 +1,29 @@
+/* Passes readv() and writev() a negative buffer count and one
+   larger than IOV_MAX, which must fail with -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char buf[IOV_MAX + 1];
+  struct iovec iov[IOV_MAX + 1];
+  int handle, i;
+
+  for (i = 0; i <= IOV_MAX; i++)
+    {
+      iov[i].iov_base = buf + i;
+      iov[i].iov_len = 1;
+    }
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (readv (handle, iov, -1) == -1, "readv with count -1");
+  CHECK (readv (handle, iov, IOV_MAX + 1) == -1,
+         "readv with count IOV_MAX + 1");
+  CHECK (writev (handle, iov, -1) == -1, "writev with count -1");
+  CHECK (writev (handle, iov, IOV_MAX + 1) == -1,
+         "writev with count IOV_MAX + 1");
+  CHECK (tell (handle) == 0, "file position unchanged");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-bad-cnt) begin
+(readv-bad-cnt) open "sample.txt"
+(readv-bad-cnt) readv with count -1
+(readv-bad-cnt) readv with count IOV_MAX + 1
+(readv-bad-cnt) writev with count -1
+(readv-bad-cnt) writev with count IOV_MAX + 1
+(readv-bad-cnt) file position unchanged
+(readv-bad-cnt) end
+readv-bad-cnt: exit(0)
+EOF
+pass;
@@ -0,0 +1,16 @@
+/* Passes an invalid pointer to the buffer array of readv().
+   The process must be terminated with -1 exit code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  readv (handle, (struct iovec *) 0xc0100000, 1);
+  fail ("should not have survived readv()");
+}
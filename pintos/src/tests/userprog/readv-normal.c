@@ -0,0 +1,58 @@
+/* Reads "sample.txt" with readv() into buffers of uneven sizes,
+   checking that each call fills them in order and advances the
+   file position, and that a call that reaches the end of the
+   file comes up short. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char a[7], b[50], c[100];
+  struct iovec iov[3];
+  size_t size = sizeof sample - 1;
+  size_t ofs;
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  iov[0].iov_base = a;
+  iov[0].iov_len = sizeof a;
+  iov[1].iov_base = b;
+  iov[1].iov_len = sizeof b;
+  iov[2].iov_base = c;
+  iov[2].iov_len = sizeof c;
+
+  msg ("readv into 3 buffers");
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != sizeof a + sizeof b + sizeof c)
+    fail ("readv() returned %d instead of %zu",
+          byte_cnt, sizeof a + sizeof b + sizeof c);
+  compare_bytes (a, sample, sizeof a, 0, "sample.txt");
+  compare_bytes (b, sample + sizeof a, sizeof b, sizeof a, "sample.txt");
+  ofs = sizeof a + sizeof b;
+  compare_bytes (c, sample + ofs, sizeof c, ofs, "sample.txt");
+  ofs += sizeof c;
+  if (tell (handle) != ofs)
+    fail ("file position is %u after readv() instead of %zu",
+          tell (handle), ofs);
+
+  msg ("readv across end of file");
+  byte_cnt = readv (handle, iov + 1, 2);
+  if (byte_cnt != (int) (size - ofs))
+    fail ("readv() returned %d instead of %zu", byte_cnt, size - ofs);
+  compare_bytes (b, sample + ofs, sizeof b, ofs, "sample.txt");
+  compare_bytes (c, sample + ofs + sizeof b, size - ofs - sizeof b,
+                 ofs + sizeof b, "sample.txt");
+  if (tell (handle) != size)
+    fail ("file position is %u after readv() instead of %zu",
+          tell (handle), size);
+
+  msg ("readv at end of file");
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != 0)
+    fail ("readv() returned %d instead of 0", byte_cnt);
+}
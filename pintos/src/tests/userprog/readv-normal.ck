@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-normal) begin
+(readv-normal) open "sample.txt"
+(readv-normal) readv into 3 buffers
+(readv-normal) readv across end of file
+(readv-normal) readv at end of file
+(readv-normal) end
+readv-normal: exit(0)
+EOF
+pass;
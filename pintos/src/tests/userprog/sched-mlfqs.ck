@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sched-mlfqs) begin
+(child-sched) get own priority
+(child-sched) setpriority under mlfqs
+(child-sched) get own nice value
+(child-sched) raise own nice value
+(child-sched) lower own nice value
+(child-sched) nice value unchanged
+(child-sched) setpriority on parent
+(child-sched) getpriority on parent
+(child-sched) nice on parent
+child-sched: exit(0)
+(sched-mlfqs) wait(exec()) = 0
+(sched-mlfqs) end
+sched-mlfqs: exit(0)
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Runs child-sched, which checks what a process started by
+   another process, and so without privilege, may do with
+   setpriority(), getpriority() and nice().  We pass it our pid
+   for it to try them on, since we are not its child.
+
+   This file is built as both sched-perm and sched-mlfqs.  The
+   latter runs with -mlfqs and tells the child so. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns the running process's pid.  While we have no children,
+   getpriority() accepts no pid other than 0 and our own. */
+static pid_t
+find_own_pid (void) 
+{
+  pid_t pid;
+
+  for (pid = 1; pid < 4096; pid++)
+    if (getpriority (pid) != -1)
+      return pid;
+  fail ("getpriority() accepted no pid");
+}
+
+void
+test_main (void) 
+{
+  char cmd[64];
+
+  snprintf (cmd, sizeof cmd, "child-sched %d%s", find_own_pid (),
+            !strcmp (test_name, "sched-mlfqs") ? " mlfqs" : "");
+  msg ("wait(exec()) = %d", wait (exec (cmd)));
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sched-perm) begin
+(child-sched) get own priority
+(child-sched) lower own priority
+(child-sched) priority lowered
+(child-sched) raise own priority
+(child-sched) priority unchanged
+(child-sched) get own nice value
+(child-sched) raise own nice value
+(child-sched) lower own nice value
+(child-sched) nice value unchanged
+(child-sched) setpriority on parent
+(child-sched) getpriority on parent
+(child-sched) nice on parent
+child-sched: exit(0)
+(sched-perm) wait(exec()) = 0
+(sched-perm) end
+sched-perm: exit(0)
+EOF
+pass;
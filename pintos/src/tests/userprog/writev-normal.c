@@ -0,0 +1,37 @@
+/* Writes "test.txt" with writev() from buffers of uneven sizes,
+   checking that they are written in order and that the file
+   position advances, then reads the file back. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct iovec iov[3];
+  size_t size = sizeof sample - 1;
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  iov[0].iov_base = sample;
+  iov[0].iov_len = 1;
+  iov[1].iov_base = sample + 1;
+  iov[1].iov_len = 100;
+  iov[2].iov_base = sample + 101;
+  iov[2].iov_len = size - 101;
+
+  msg ("writev from 3 buffers");
+  byte_cnt = writev (handle, iov, 3);
+  if (byte_cnt != (int) size)
+    fail ("writev() returned %d instead of %zu", byte_cnt, size);
+  if (tell (handle) != size)
+    fail ("file position is %u after writev() instead of %zu",
+          tell (handle), size);
+
+  seek (handle, 0);
+  check_file_handle (handle, "test.txt", sample, size);
+}
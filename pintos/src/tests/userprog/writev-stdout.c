@@ -0,0 +1,28 @@
+/* Writes a line to the console with writev(). */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char *parts[] = {"Hello", ", ", "writev", "!\n"};
+  struct iovec iov[4];
+  size_t total = 0;
+  int i, byte_cnt;
+
+  for (i = 0; i < 4; i++)
+    {
+      iov[i].iov_base = parts[i];
+      iov[i].iov_len = strlen (parts[i]);
+      total += iov[i].iov_len;
+    }
+
+  msg ("writev to stdout");
+  byte_cnt = writev (STDOUT_FILENO, iov, 4);
+  if (byte_cnt != (int) total)
+    fail ("writev() returned %d instead of %zu", byte_cnt, total);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(writev-stdout) begin
+(writev-stdout) writev to stdout
+Hello, writev!
+(writev-stdout) end
+writev-stdout: exit(0)
+EOF
+pass;
@@ -0,0 +1,26 @@
+#include "threads/cpu.h"
+#include <string.h>
+
+/* Processors. */
+struct cpu cpus[CPU_CNT];
+
+/* Sets up each processor's `struct cpu'.  Must be called before
+   thread_init(), which uses the bootstrap processor's run
+   queue. */
+void
+cpu_init (void) 
+{
+  unsigned id;
+
+  for (id = 0; id < CPU_CNT; id++)
+    {
+      struct cpu *c = &cpus[id];
+      int i;
+
+      memset (c, 0, sizeof *c);
+      c->id = id;
+      for (i = PRI_MIN; i <= PRI_MAX; i++)
+        list_init (&c->rq.queues[i]);
+      list_init (&c->rq.edf);
+    }
+}
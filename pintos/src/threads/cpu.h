@@ -0,0 +1,106 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/thread.h"
+
+/* Number of processors that run threads.
+
+   Pintos runs only on the bootstrap processor; SMP is not
+   supported.  `struct cpu' gathers the scheduler state that would
+   be per-processor under SMP, but running threads on other
+   processors still needs local and I/O APIC drivers, a real-mode
+   startup trampoline for the application processors, and mutual
+   exclusion that holds across processors instead of disabling
+   interrupts. */
+#define CPU_CNT 1
+
+/* Run queues of threads in THREAD_READY state, that is, threads
+   that are ready to run but not actually running.  There is one
+   FIFO queue per priority level.  Bit P of `bitmap' is set if
+   and only if queues[P] is nonempty, so the highest nonempty
+   level can be found with a single bit scan instead of a walk
+   over every ready thread.
+
+   Under stride scheduling the ready threads are kept instead in
+   `heap', a binary min-heap ordered on pass value.
+
+   Threads in the earliest-deadline-first class wait apart from
+   all others in `edf', ordered by deadline, and run first. */
+#define READY_WORDS ((PRI_MAX + 32) / 32)
+struct ready_queue
+  {
+    struct list queues[PRI_MAX + 1];    /* One FIFO per priority. */
+    uint32_t bitmap[READY_WORDS];       /* Nonempty queues. */
+    size_t cnt;                         /* # of threads queued, in all. */
+    struct list edf;                    /* EDF threads, by deadline. */
+    struct thread **heap;               /* Stride: HEAP_CNT threads. */
+    size_t heap_cnt;                    /* Stride: # of threads in heap. */
+    int64_t pass;                       /* Stride: global pass. */
+  };
+
+/* A processor. */
+struct cpu
+  {
+    unsigned id;                /* Index into cpus[]. */
+    struct thread *idle_thread; /* This CPU's idle thread. */
+    struct ready_queue rq;      /* Threads ready to run here. */
+    int preempt_cnt;            /* Nesting of thread_preempt_disable(). */
+    bool preempt_pending;       /* Preemption deferred by preempt_cnt? */
+
+    /* Statistics. */
+    long long idle_ticks;       /* # of timer ticks spent idle. */
+    long long kernel_ticks;     /* # of timer ticks in kernel threads. */
+    long long user_ticks;       /* # of timer ticks in user programs. */
+  };
+
+/* Processors. */
+extern struct cpu cpus[CPU_CNT];
+
+void cpu_init (void);
+
+/* Returns the processor we are running on. */
+static inline struct cpu *
+cpu_current (void) 
+{
+  return &cpus[0];
+}
+
+/* Returns the processor's time stamp counter, which counts
+   clock cycles since reset. */
+static inline uint64_t
+rdtsc (void) 
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Executes CPUID for LEAF, storing %eax, %ebx, %ecx and %edx
+   in REGS[0] through REGS[3]. */
+static inline void
+cpuid (uint32_t leaf, uint32_t regs[4]) 
+{
+  asm volatile ("cpuid"
+                : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+                : "a" (leaf), "c" (0));
+}
+
+/* Model-specific registers for SYSENTER: the code segment, stack
+   pointer and entry point that it loads.  See [IA32-v2b]
+   "SYSENTER". */
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+/* Writes VALUE to model-specific register MSR. */
+static inline void
+wrmsr (uint32_t msr, uint64_t value) 
+{
+  asm volatile ("wrmsr" : : "c" (msr), "A" (value));
+}
+
+#endif /* threads/cpu.h */
@@ -15,6 +15,7 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
@@ -22,6 +23,8 @@
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -85,8 +88,9 @@ main (void)
   argv = read_command_line ();
   argv = parse_options (argv);
 
-  /* Initialize ourselves as a thread so we can use locks,
-     then enable console locking. */
+  /* Set up per-CPU data, then initialize ourselves as a thread
+     so we can use locks, then enable console locking. */
+  cpu_init ();
   thread_init ();
   console_init ();  
 
@@ -98,6 +102,7 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+  trace_init ();
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -105,7 +110,9 @@ main (void)
   gdt_init ();
 #endif
 
-  /* Initialize interrupt handlers. */
+  /* Initialize interrupt handlers, and the workqueues they may
+     push work out to. */
+  workqueue_init ();
   intr_init ();
   timer_init ();
   kbd_init ();
@@ -117,6 +124,7 @@ main (void)
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  workqueue_start ();
   serial_init_queue ();
   timer_calibrate ();
 
@@ -125,7 +133,6 @@ main (void)
   ide_init ();
   locate_block_devices ();
   filesys_init (format_filesys);
-  lock_init(&filesys_lock);
 #endif
 
   printf ("Boot complete.\n");
@@ -253,10 +260,34 @@ parse_options (char **argv)
         swap_bdev_name = value;
 #endif
 #endif
+      else if (!strcmp (name, "-baud"))
+        {
+          if (value == NULL || !serial_set_bps (atoi (value)))
+            PANIC ("unsupported baud rate \"%s\" (use -h for help)", value);
+        }
       else if (!strcmp (name, "-rs"))
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-stride"))
+        thread_stride = true;
+      else if (!strcmp (name, "-tickless"))
+        timer_tickless = true;
+      else if (!strcmp (name, "-tcache"))
+        {
+          int size = value != NULL ? atoi (value) : -1;
+
+          if (size < 0)
+            PANIC ("invalid thread cache size \"%s\" (use -h for help)",
+                   value);
+          thread_cache_size = size;
+        }
+      else if (!strcmp (name, "-trace"))
+        {
+          if (!trace_configure (value))
+            PANIC ("unknown trace destination \"%s\" (use -h for help)",
+                   value);
+        }
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
@@ -268,6 +299,8 @@ parse_options (char **argv)
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
+  if (thread_mlfqs && thread_stride)
+    PANIC ("-mlfqs and -stride cannot be used together");
 
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
@@ -382,8 +415,15 @@ usage (void)
           "  -swap=BDEV         Use BDEV for swap instead of default.\n"
 #endif
 #endif
+          "  -baud=BPS          Run the serial port at BPS bits per second, which\n"
+          "                     must divide 115200 (default: 115200).\n"
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -stride            Use stride (proportional-share) scheduler.\n"
+          "  -tickless          Stop the timer tick while the CPU is idle.\n"
+          "  -tcache=N          Keep up to N exited threads' pages for reuse.\n"
+          "  -trace=DEST        Trace scheduler events; dump them at shutdown\n"
+          "                     to DEST, which is `console' or `scratch'.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -224,6 +224,27 @@ intr_yield_on_return (void)
   ASSERT (intr_context ());
   yield_on_return = true;
 }
+
+/* Returns true if external interrupt VEC_NO has been raised by
+   its device but not yet delivered, as happens while interrupts
+   are off. */
+bool
+intr_ext_pending (uint8_t vec_no) 
+{
+  ASSERT (vec_no >= 0x20 && vec_no <= 0x2f);
+
+  /* OCW3: read the Interrupt Request Register. */
+  if (vec_no < 0x28)
+    {
+      outb (PIC0_CTRL, 0x0a);
+      return (inb (PIC0_CTRL) & (1 << (vec_no - 0x20))) != 0;
+    }
+  else
+    {
+      outb (PIC1_CTRL, 0x0a);
+      return (inb (PIC1_CTRL) & (1 << (vec_no - 0x28))) != 0;
+    }
+}
 
 /* 8259A Programmable Interrupt Controller. */
 
@@ -383,7 +404,7 @@ intr_handler (struct intr_frame *frame)
       in_external_intr = false;
       pic_end_of_interrupt (frame->vec_no); 
 
-      if (yield_on_return) 
+      if (yield_on_return && thread_preempt_check ()) 
         thread_yield (); 
     }
 }
@@ -0,0 +1,125 @@
+#include "threads/spinlock.h"
+#include <debug.h>
+#include "threads/thread.h"
+
+static void spin_lock (struct spinlock *);
+static void spin_unlock (struct spinlock *);
+
+/* Initializes LOCK as unlocked. */
+void
+spinlock_init (struct spinlock *lock) 
+{
+  ASSERT (lock != NULL);
+
+  lock->next = lock->owner = 0;
+}
+
+/* Acquires LOCK, spinning until it is available, and disables
+   preemption of the running thread until it is released.  LOCK
+   must not be used from interrupt handlers (see
+   spinlock_acquire_irqsave()), and the caller must not sleep
+   while holding it. */
+void
+spinlock_acquire (struct spinlock *lock) 
+{
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+
+  thread_preempt_disable ();
+  spin_lock (lock);
+}
+
+/* Acquires LOCK if it is available right now, without spinning.
+   Returns true if successful, false otherwise. */
+bool
+spinlock_try_acquire (struct spinlock *lock) 
+{
+  int ticket;
+
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+
+  thread_preempt_disable ();
+  ticket = lock->owner;
+  if (lock->next == ticket
+      && atomic_cmpxchg (&lock->next, ticket, ticket + 1) == ticket)
+    return true;
+  thread_preempt_enable ();
+  return false;
+}
+
+/* Releases LOCK, which was acquired with spinlock_acquire() or
+   spinlock_try_acquire(), and enables preemption again.  If a
+   preemption was requested while LOCK was held, the running
+   thread yields now. */
+void
+spinlock_release (struct spinlock *lock) 
+{
+  ASSERT (lock != NULL);
+
+  spin_unlock (lock);
+  thread_preempt_enable ();
+}
+
+/* Disables interrupts, acquires LOCK, and returns the previous
+   interrupt level, which must be passed to the matching
+   spinlock_release_irqrestore().  This is the form to use for
+   data shared with interrupt handlers, and it may be called
+   from one. */
+enum intr_level
+spinlock_acquire_irqsave (struct spinlock *lock) 
+{
+  enum intr_level old_level;
+
+  ASSERT (lock != NULL);
+
+  old_level = intr_disable ();
+  spin_lock (lock);
+  return old_level;
+}
+
+/* Releases LOCK and then sets the interrupt level to OLD_LEVEL. */
+void
+spinlock_release_irqrestore (struct spinlock *lock,
+                             enum intr_level old_level) 
+{
+  ASSERT (lock != NULL);
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  spin_unlock (lock);
+  intr_set_level (old_level);
+}
+
+/* Returns true if some thread holds LOCK.  Useful only in
+   assertions, since the answer may be stale by the time the
+   caller looks at it. */
+bool
+spinlock_locked (const struct spinlock *lock) 
+{
+  ASSERT (lock != NULL);
+
+  return lock->next != lock->owner;
+}
+
+/* Takes a ticket for LOCK and spins until it is served. */
+static void
+spin_lock (struct spinlock *lock) 
+{
+  int ticket = atomic_fetch_add (&lock->next, 1);
+
+  while (lock->owner != ticket)
+    cpu_relax ();
+  read_barrier ();
+}
+
+/* Serves the next ticket for LOCK.  Only the holder writes the
+   owner field, so no locked instruction is needed, just a
+   barrier to keep the critical section's stores ahead of it. */
+static void
+spin_unlock (struct spinlock *lock) 
+{
+  ASSERT (spinlock_locked (lock));
+
+  write_barrier ();
+  lock->owner = (int) ((unsigned) lock->owner + 1);
+}
@@ -0,0 +1,131 @@
+#ifndef THREADS_SPINLOCK_H
+#define THREADS_SPINLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+
+/* Atomic operations.
+
+   Each of these is a single `lock'-prefixed (or implicitly
+   locked) instruction, so it is atomic with respect to other
+   processors as well as to interrupt handlers on this one.  Each
+   is also a full memory barrier, for the compiler and for the
+   processor. */
+
+/* Atomically adds V to *P and returns the old value of *P. */
+static inline int
+atomic_fetch_add (volatile int *p, int v) 
+{
+  /* See [IA32-v2b] "XADD". */
+  asm volatile ("lock xaddl %0, %1" : "+r" (v), "+m" (*p) : : "memory");
+  return v;
+}
+
+/* Atomically sets *P to NEW if it equals OLD.  Returns the value
+   *P had beforehand, so the exchange happened if and only if the
+   return value equals OLD. */
+static inline int
+atomic_cmpxchg (volatile int *p, int old, int new) 
+{
+  /* See [IA32-v2a] "CMPXCHG". */
+  int prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p)
+                : "r" (new), "0" (old)
+                : "memory");
+  return prev;
+}
+
+/* Atomically sets *P to V and returns the old value of *P. */
+static inline int
+atomic_xchg (volatile int *p, int v) 
+{
+  /* See [IA32-v2b] "XCHG".  XCHG with a memory operand is
+     always locked. */
+  asm volatile ("xchgl %0, %1" : "+r" (v), "+m" (*p) : : "memory");
+  return v;
+}
+
+/* Pointer-sized compare-and-exchange, for lock-free lists. */
+static inline void *
+atomic_cmpxchg_ptr (void *volatile *p, void *old, void *new) 
+{
+  return (void *) atomic_cmpxchg ((volatile int *) p, (int) old, (int) new);
+}
+
+/* Pointer-sized exchange. */
+static inline void *
+atomic_xchg_ptr (void *volatile *p, void *v) 
+{
+  return (void *) atomic_xchg ((volatile int *) p, (int) v);
+}
+
+/* Memory barriers.
+
+   x86 only lets a later load pass an earlier store to a
+   different address, so only memory_barrier() needs to emit an
+   instruction.  The read and write barriers just keep the
+   compiler from reordering accesses across them. */
+
+/* Orders all earlier loads and stores before all later ones. */
+static inline void
+memory_barrier (void) 
+{
+  /* A locked no-op on the stack; unlike MFENCE, it works on
+     every IA-32 processor. */
+  asm volatile ("lock addl $0, (%%esp)" : : : "memory", "cc");
+}
+
+/* Orders earlier loads before later loads. */
+static inline void
+read_barrier (void) 
+{
+  asm volatile ("" : : : "memory");
+}
+
+/* Orders earlier stores before later stores. */
+static inline void
+write_barrier (void) 
+{
+  asm volatile ("" : : : "memory");
+}
+
+/* Tells the processor we are in a spin-wait loop. */
+static inline void
+cpu_relax (void) 
+{
+  /* See [IA32-v2b] "PAUSE". */
+  asm volatile ("pause" : : : "memory");
+}
+
+/* A ticket spinlock.
+
+   A thread takes the next ticket and spins until the owner field
+   reaches it, so waiters acquire the lock in arrival order.
+
+   A spinlock protects short critical sections that must not
+   sleep.  spinlock_acquire() disables preemption of the running
+   thread instead of interrupts, so interrupt handlers keep
+   running while it is held; it must therefore not be used for
+   data that an interrupt handler also touches.  For such data,
+   use spinlock_acquire_irqsave(), which turns interrupts off
+   for the duration as well. */
+struct spinlock
+  {
+    volatile int next;          /* Next ticket to hand out. */
+    volatile int owner;         /* Ticket now holding the lock. */
+  };
+
+/* Initializer for a spinlock with static storage duration. */
+#define SPINLOCK_INITIALIZER { 0, 0 }
+
+void spinlock_init (struct spinlock *);
+void spinlock_acquire (struct spinlock *);
+bool spinlock_try_acquire (struct spinlock *);
+void spinlock_release (struct spinlock *);
+enum intr_level spinlock_acquire_irqsave (struct spinlock *);
+void spinlock_release_irqrestore (struct spinlock *, enum intr_level);
+bool spinlock_locked (const struct spinlock *);
+
+#endif /* threads/spinlock.h */
@@ -31,6 +31,10 @@
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+
+static void sema_down_at (struct semaphore *, const void *where);
+static void sema_wait (struct semaphore *, const void *where);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -48,6 +52,22 @@ sema_init (struct semaphore *sema, unsigned value)
 
   sema->value = value;
   list_init (&sema->waiters);
+  sema->handoff = false;
+  spinlock_init (&sema->lock);
+}
+
+/* Turns hand-off mode on or off for SEMA.  In hand-off mode,
+   sema_up() passes its unit directly to the waiter it wakes
+   instead of adding it to SEMA's value, so a thread that calls
+   sema_down() before the woken waiter gets to run cannot take
+   the unit out from under it.  Without hand-off, such a thread
+   may barge in and the woken waiter goes back to sleep. */
+void
+sema_set_handoff (struct semaphore *sema, bool handoff) 
+{
+  ASSERT (sema != NULL);
+
+  sema->handoff = handoff;
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -59,21 +79,52 @@ sema_init (struct semaphore *sema, unsigned value)
    thread will probably turn interrupts back on. */
 void
 sema_down (struct semaphore *sema) 
+{
+  sema_down_at (sema, __builtin_return_address (0));
+}
+
+/* Does the work of sema_down().  WHERE is the code that asked
+   to wait, for the scheduler trace. */
+static void
+sema_down_at (struct semaphore *sema, const void *where) 
 {
   enum intr_level old_level;
 
   ASSERT (sema != NULL);
   ASSERT (!intr_context ());
 
-  old_level = intr_disable ();
-  while (sema->value == 0) 
+  old_level = spinlock_acquire_irqsave (&sema->lock);
+  if (sema->value > 0)
+    sema->value--;
+  else if (sema->handoff)
     {
-      list_insert_ordered(&sema->waiters, &thread_current()->elem, ready_less, NULL);
-//      list_push_back (&sema->waiters, &thread_current ()->elem);
-      thread_block ();
+      /* sema_up() hands its unit to us without touching the
+         value, so there is nothing to recheck on wakeup. */
+      sema_wait (sema, where);
     }
-  sema->value--;
-  intr_set_level (old_level);
+  else
+    {
+      while (sema->value == 0) 
+        sema_wait (sema, where);
+      sema->value--;
+    }
+  spinlock_release_irqrestore (&sema->lock, old_level);
+}
+
+/* Adds the running thread to SEMA's waiters and blocks until a
+   sema_up() wakes it.  SEMA's spinlock must be held, with
+   interrupts off; it is dropped while we sleep.  Interrupts stay
+   off until we block, so no sema_up() on this CPU can slip in
+   between joining the waiters and blocking.  WHERE is recorded
+   in the scheduler trace. */
+static void
+sema_wait (struct semaphore *sema, const void *where) 
+{
+  trace_record (TRACE_BLOCK, thread_current ()->tid, 0, 0, where);
+  list_push_back (&sema->waiters, &thread_current ()->elem);
+  spinlock_release_irqrestore (&sema->lock, INTR_OFF);
+  thread_block ();
+  spinlock_acquire_irqsave (&sema->lock);
 }
 
 /* Down or "P" operation on a semaphore, but only if the
@@ -89,7 +140,7 @@ sema_try_down (struct semaphore *sema)
 
   ASSERT (sema != NULL);
 
-  old_level = intr_disable ();
+  old_level = spinlock_acquire_irqsave (&sema->lock);
   if (sema->value > 0) 
     {
       sema->value--;
@@ -97,31 +148,66 @@ sema_try_down (struct semaphore *sema)
     }
   else
     success = false;
-  intr_set_level (old_level);
+  spinlock_release_irqrestore (&sema->lock, old_level);
 
   return success;
 }
 
+/* Releases one unit of SEMA: wakes up the highest-priority
+   thread waiting for SEMA, if any, and either hands the unit to
+   it (in hand-off mode) or adds it to SEMA's value.  Returns the
+   woken thread, or a null pointer if there were no waiters.
+   Waiters are kept in arrival order and searched here, rather
+   than sorted on insertion, because a waiter's priority may
+   change through donation while it sleeps.  May be called from
+   an interrupt handler. */
+static struct thread *
+sema_release (struct semaphore *sema) 
+{
+  struct thread *woken = NULL;
+  enum intr_level old_level;
+
+  old_level = spinlock_acquire_irqsave (&sema->lock);
+  if (!list_empty (&sema->waiters)) 
+    {
+      struct list_elem *e = list_max (&sema->waiters,
+                                      thread_priority_less, NULL);
+      list_remove (e);
+      woken = list_entry (e, struct thread, elem);
+      thread_unblock (woken);
+    }
+  if (woken == NULL || !sema->handoff)
+    sema->value++;
+  spinlock_release_irqrestore (&sema->lock, old_level);
+  return woken;
+}
+
+/* Yields the CPU if WOKEN, a thread just woken by sema_release(),
+   outranks the running thread.  In an interrupt handler, the
+   yield is deferred until the handler returns. */
+static void
+sema_preempt (struct thread *woken) 
+{
+  if (woken == NULL || !thread_preempts (woken))
+    return;
+  if (intr_context ())
+    intr_yield_on_return ();
+  else
+    thread_yield ();
+}
+
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any.  The CPU is given up to the woken thread only if
+   it has higher priority than the caller.
 
    This function may be called from an interrupt handler. */
 void
 sema_up (struct semaphore *sema) 
 {
-  enum intr_level old_level;
-
   ASSERT (sema != NULL);
 
-  old_level = intr_disable ();
-  if (!list_empty (&sema->waiters)) {
-//    list_sort(&sema->waiters, ready_less, NULL);
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
-  }
-  sema->value++;
-  intr_set_level (old_level);
-  thread_yield();
+  sema_preempt (sema_release (sema));
 }
 
 static void sema_test_helper (void *sema_);
@@ -182,9 +268,104 @@ lock_init (struct lock *lock)
   ASSERT (lock != NULL);
 
   lock->holder = NULL;
+  lock->priority = PRI_MIN;
+  lock->tickets = 0;
   sema_init (&lock->semaphore, 1);
 }
 
+/* Turns hand-off mode on or off for LOCK.  In hand-off mode,
+   lock_release() makes the highest-priority waiter the holder
+   right away, so that no other thread can acquire LOCK between
+   its release and the waiter getting to run.  This trades some
+   throughput for strict priority order among contenders. */
+void
+lock_set_handoff (struct lock *lock, bool handoff) 
+{
+  ASSERT (lock != NULL);
+
+  sema_set_handoff (&lock->semaphore, handoff);
+}
+
+/* Donates PRIORITY to the holder of LOCK and, if that holder is
+   itself waiting on a lock, on down the chain of holders, up to
+   LOCK_DONATION_DEPTH locks deep.  Stops early once a holder
+   already runs at PRIORITY or above, since everything further
+   down the chain then does too.  Interrupts must be off. */
+static void
+lock_donate (struct lock *lock, int priority)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; depth < LOCK_DONATION_DEPTH; depth++)
+    {
+      struct thread *holder;
+
+      if (lock == NULL || lock->holder == NULL)
+        break;
+      holder = lock->holder;
+      if (lock->priority < priority)
+        lock->priority = priority;
+      if (holder->priority >= priority)
+        break;
+      thread_refresh_priority (holder);
+      lock = holder->waiting_lock;
+    }
+}
+
+/* Under stride scheduling, lends TICKETS to the holder of LOCK
+   and, if that holder is itself waiting on a lock, on down the
+   chain of holders, up to LOCK_DONATION_DEPTH locks deep.  The
+   tickets are counted in each lock on the chain, so that a
+   holder runs with those of every thread waiting on it, directly
+   or not.  Interrupts must be off. */
+static void
+lock_lend (struct lock *lock, int tickets)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; depth < LOCK_DONATION_DEPTH; depth++)
+    {
+      if (lock == NULL || lock->holder == NULL)
+        break;
+      lock->tickets += tickets;
+      lock = lock->holder->waiting_lock;
+    }
+}
+
+/* Makes T the holder of LOCK, which has just been downed on its
+   behalf.  The donation recorded in LOCK is reset to the highest
+   priority among the threads still waiting for it, all of which
+   now wait on T, and its lent tickets to the sum of theirs.
+   Interrupts must be off. */
+static void
+lock_take (struct lock *lock, struct thread *t)
+{
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  lock->holder = t;
+  t->waiting_lock = NULL;
+  list_push_back (&t->locks, &lock->elem);
+  lock->priority = PRI_MIN;
+  if (!list_empty (&lock->semaphore.waiters))
+    lock->priority = list_entry (list_max (&lock->semaphore.waiters,
+                                           thread_priority_less, NULL),
+                                 struct thread, elem)->priority;
+  lock->tickets = 0;
+  if (thread_stride)
+    for (e = list_begin (&lock->semaphore.waiters);
+         e != list_end (&lock->semaphore.waiters); e = list_next (e))
+      lock->tickets += thread_stride_tickets (list_entry (e, struct thread,
+                                                          elem));
+  if (!thread_mlfqs)
+    thread_refresh_priority (t);
+}
+
 /* Acquires LOCK, sleeping until it becomes available if
    necessary.  The lock must not already be held by the current
    thread.
@@ -192,16 +373,33 @@ lock_init (struct lock *lock)
    This function may sleep, so it must not be called within an
    interrupt handler.  This function may be called with
    interrupts disabled, but interrupts will be turned back on if
-   we need to sleep. */
+   we need to sleep.
+
+   While we wait, our priority is donated to the holder (and
+   along the chain of locks it waits on) so that a lower-priority
+   holder cannot be starved by threads in between. */
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  old_level = intr_disable ();
+  if (lock->holder != NULL && !thread_mlfqs)
+    {
+      cur->waiting_lock = lock;
+      lock_donate (lock, cur->priority);
+      if (thread_stride)
+        lock_lend (lock, thread_stride_tickets (cur));
+    }
+  sema_down_at (&lock->semaphore, __builtin_return_address (0));
+  if (lock->holder != cur)
+    lock_take (lock, cur);
+  intr_set_level (old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -213,14 +411,17 @@ lock_acquire (struct lock *lock)
 bool
 lock_try_acquire (struct lock *lock)
 {
+  enum intr_level old_level;
   bool success;
 
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    lock_take (lock, thread_current ());
+  intr_set_level (old_level);
   return success;
 }
 
@@ -228,15 +429,33 @@ lock_try_acquire (struct lock *lock)
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
-   handler. */
+   handler.
+
+   Any priority donated through LOCK is given back here, before
+   the next holder is woken.  In hand-off mode the woken waiter
+   becomes the holder immediately. */
 void
 lock_release (struct lock *lock) 
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  struct thread *next;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
   lock->holder = NULL;
-  sema_up (&lock->semaphore);
+  list_remove (&lock->elem);
+  lock->priority = PRI_MIN;
+  lock->tickets = 0;
+  if (!thread_mlfqs)
+    thread_refresh_priority (cur);
+  next = sema_release (&lock->semaphore);
+  if (next != NULL && lock->semaphore.handoff)
+    lock_take (lock, next);
+  intr_set_level (old_level);
+  sema_preempt (next);
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -255,8 +474,19 @@ struct semaphore_elem
   {
     struct list_elem elem;              /* List element. */
     struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Thread waiting on it. */
   };
 
+/* Returns true if the thread waiting on semaphore_elem A has
+   lower priority than the one waiting on B. */
+static bool
+waiter_less (const struct list_elem *a, const struct list_elem *b,
+             void *aux UNUSED) 
+{
+  return list_entry (a, struct semaphore_elem, elem)->thread->priority
+         < list_entry (b, struct semaphore_elem, elem)->thread->priority;
+}
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -299,6 +529,7 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current ();
   list_push_back (&cond->waiters, &waiter.elem);
   lock_release (lock);
   sema_down (&waiter.semaphore);
@@ -306,8 +537,9 @@ cond_wait (struct condition *cond, struct lock *lock)
 }
 
 /* If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
-   LOCK must be held before calling this function.
+   this function signals the highest-priority one to wake up from
+   its wait, or the earliest of those tied for highest.  LOCK
+   must be held before calling this function.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to signal a condition variable within an
@@ -321,8 +553,11 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (lock_held_by_current_thread (lock));
 
   if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+    {
+      struct list_elem *e = list_max (&cond->waiters, waiter_less, NULL);
+      list_remove (e);
+      sema_up (&list_entry (e, struct semaphore_elem, elem)->semaphore);
+    }
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -340,3 +575,104 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes RWLOCK as a readers-writer lock held by no one.
+
+   The lock prefers writers: once a writer is waiting, threads
+   asking for shared access wait behind it, so a steady stream of
+   readers cannot starve writers.  Within each class, waiters are
+   woken in priority order. */
+void
+rwlock_init (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  lock_init (&rwlock->lock);
+  cond_init (&rwlock->readers);
+  cond_init (&rwlock->writers);
+  rwlock->reader_cnt = 0;
+  rwlock->writer_cnt = 0;
+  rwlock->writer = NULL;
+}
+
+/* Acquires RWLOCK for shared access, sleeping while a writer
+   holds it or is waiting for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_shared (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rwlock->writer != thread_current ());
+
+  lock_acquire (&rwlock->lock);
+  while (rwlock->writer != NULL || rwlock->writer_cnt > 0)
+    cond_wait (&rwlock->readers, &rwlock->lock);
+  rwlock->reader_cnt++;
+  lock_release (&rwlock->lock);
+}
+
+/* Releases shared access to RWLOCK.  The last reader out lets in
+   a waiting writer, if any. */
+void
+rwlock_release_shared (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  lock_acquire (&rwlock->lock);
+  ASSERT (rwlock->reader_cnt > 0);
+  if (--rwlock->reader_cnt == 0 && rwlock->writer_cnt > 0)
+    cond_signal (&rwlock->writers, &rwlock->lock);
+  lock_release (&rwlock->lock);
+}
+
+/* Acquires RWLOCK for exclusive access, sleeping until no other
+   thread holds it in either mode.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_exclusive (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_held_exclusive (rwlock));
+
+  lock_acquire (&rwlock->lock);
+  rwlock->writer_cnt++;
+  while (rwlock->writer != NULL || rwlock->reader_cnt > 0)
+    cond_wait (&rwlock->writers, &rwlock->lock);
+  rwlock->writer_cnt--;
+  rwlock->writer = thread_current ();
+  lock_release (&rwlock->lock);
+}
+
+/* Releases exclusive access to RWLOCK, which the current thread
+   must hold.  Hands RWLOCK to the next waiting writer if there
+   is one, and otherwise lets in all waiting readers. */
+void
+rwlock_release_exclusive (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (rwlock_held_exclusive (rwlock));
+
+  lock_acquire (&rwlock->lock);
+  rwlock->writer = NULL;
+  if (rwlock->writer_cnt > 0)
+    cond_signal (&rwlock->writers, &rwlock->lock);
+  else
+    cond_broadcast (&rwlock->readers, &rwlock->lock);
+  lock_release (&rwlock->lock);
+}
+
+/* Returns true if the current thread holds RWLOCK exclusive,
+   false otherwise. */
+bool
+rwlock_held_exclusive (const struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  return rwlock->writer == thread_current ();
+}
@@ -3,15 +3,19 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include "threads/spinlock.h"
 
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
     struct list waiters;        /* List of waiting threads. */
+    bool handoff;               /* Pass units straight to waiters? */
+    struct spinlock lock;       /* Protects the members above. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
+void sema_set_handoff (struct semaphore *, bool);
 void sema_down (struct semaphore *);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
@@ -22,9 +26,18 @@ struct lock
   {
     struct thread *holder;      /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct list_elem elem;      /* Element in holder's `locks' list. */
+    int priority;               /* Highest priority donated through it. */
+    int tickets;                /* Stride tickets lent by waiters. */
   };
 
+/* Maximum number of locks a priority donation is propagated
+   through when the holder of a lock is itself waiting on
+   another lock.  Longer chains stop donating at this depth. */
+#define LOCK_DONATION_DEPTH 8
+
 void lock_init (struct lock *);
+void lock_set_handoff (struct lock *, bool);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
@@ -41,6 +54,25 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Readers-writer lock.  Any number of threads may hold it
+   shared, or one thread may hold it exclusive. */
+struct rwlock
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition readers;   /* Signaled when readers may enter. */
+    struct condition writers;   /* Signaled when a writer may enter. */
+    int reader_cnt;             /* # of threads holding it shared. */
+    int writer_cnt;             /* # of writers waiting for it. */
+    struct thread *writer;      /* Exclusive holder, or NULL. */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_shared (struct rwlock *);
+void rwlock_release_shared (struct rwlock *);
+void rwlock_acquire_exclusive (struct rwlock *);
+void rwlock_release_exclusive (struct rwlock *);
+bool rwlock_held_exclusive (const struct rwlock *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
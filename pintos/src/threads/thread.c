@@ -1,15 +1,18 @@
 #include "threads/thread.h"
 #include <debug.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #include "threads/malloc.h"
 #include "devices/timer.h"
@@ -22,20 +25,27 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-static struct list block_list;
-
 static REAL load_avg;
 
+/* MLFQS recent_cpu decay history.  decay_epoch counts the
+   once-per-second recent_cpu updates so far.  Update E computed
+   the decay coefficient 2*load_avg / (2*load_avg + 1) once, in
+   fixed point, and stored it in decay_coef[E % DECAY_HISTORY],
+   along with the load_avg it came from in decay_load[].
+
+   Only running and ready threads are decayed as each second
+   passes.  A blocked thread remembers in its own `decay_epoch'
+   how many updates it has seen, and catches up on the rest when
+   it is unblocked (see mlfqs_catch_up()). */
+#define DECAY_HISTORY 64
+static REAL decay_coef[DECAY_HISTORY];
+static REAL decay_load[DECAY_HISTORY];
+static int64_t decay_epoch;
+
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
-/* Idle thread. */
-static struct thread *idle_thread;
-
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
@@ -50,11 +60,6 @@ struct kernel_thread_frame
   void *aux;                  /* Auxiliary data for function. */
 };
 
-/* Statistics. */
-static long long idle_ticks;    /* # of timer ticks spent idle. */
-static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
-static long long user_ticks;    /* # of timer ticks in user programs. */
-
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
@@ -62,7 +67,6 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 // #ifndef USERPROG
 /* For project 1 */
 bool thread_prior_aging;
-int64_t age_ticks;
 // #endif
 
 /* If false (default), use round-robin scheduler.
@@ -70,20 +74,100 @@ int64_t age_ticks;
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Stride scheduling.
+
+   Each thread holds some number of tickets.  Every timer tick a
+   thread runs advances its pass by its stride, STRIDE1 divided by
+   its tickets, and the scheduler always runs the ready thread
+   with the lowest pass, kept at the top of a min-heap.  Over any
+   interval, then, each thread that stays ready gets CPU time in
+   proportion to its tickets.  A thread that has been blocked
+   rejoins at the run queue's global pass, the pass of the thread
+   most recently picked, so it cannot save up CPU time by
+   sleeping.  A thread waiting on a lock lends its tickets to the
+   lock's holder until it gets the lock (see synch.c). */
+bool thread_stride;
+#define STRIDE1 (1 << 20)               /* Stride of a 1-ticket thread. */
+#define STRIDE_HEAP_PAGES 2             /* Pages per run queue heap. */
+#define STRIDE_HEAP_MAX (STRIDE_HEAP_PAGES * PGSIZE / sizeof (struct thread *))
+
+/* Earliest-deadline-first class.
+
+   A thread joins with thread_set_deadline(PERIOD, BUDGET): from
+   then on it is released every PERIOD ticks, and each release
+   starts a job that must get BUDGET ticks of CPU time before the
+   next release, its deadline.  Ready EDF threads run ahead of
+   every other thread, earliest deadline first.  A thread that
+   uses up its budget is parked until its next release, so an
+   overrunning thread cannot make the others miss.  As long as
+   the budgets add up to no more than the whole CPU, which
+   admission control enforces, every job then meets its
+   deadline. */
+#define EDF_UTIL_SCALE 1000000          /* Utilization of the whole CPU. */
+static int edf_util;                    /* Sum of reserved utilization. */
+
+/* Pages of exited threads, kept for reuse so that creating a
+   thread need not go through palloc_get_page() and zero a whole
+   page.  init_thread() and alloc_frame() initialize all of a
+   page that a new thread reads before writing, that is, its
+   `struct thread' and its initial stack frames.  A cached page
+   starts with a pointer to the next one.  Interrupts must be off
+   to touch the cache, since dying threads are freed from
+   schedule(). */
+size_t thread_cache_size = THREAD_CACHE_DEFAULT;
+static void *thread_cache;
+static size_t thread_cache_cnt;
+static long long thread_cache_hits;     /* # of pages reused. */
+static long long thread_cache_misses;   /* # of pages from palloc. */
+
+/* Scheduler statistics.  Each thread notes the time stamp
+   counter in sched_stamp when it is switched in, when it is
+   switched out, and when it is unblocked; the intervals between
+   these go into its `schedstat' histograms.  The statistics of
+   exited threads are added into schedstat_exited.  Idle threads
+   are not counted. */
+static struct schedstat schedstat_exited;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
-static void thread_wake(void);
+static void thread_wake (void *t_);
 static struct thread *running_thread (void);
 static struct thread *next_thread_to_run (void);
 static void init_thread (struct thread *, const char *name, int priority);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
+static struct thread *thread_page_get (void);
+static void thread_page_put (struct thread *);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
-static bool taf_less (const struct list_elem *a, const struct list_elem *b, void* aux UNUSED);
 static tid_t allocate_tid (void);
-static void thread_aging (void);
+static void thread_age (struct thread *);
+static void thread_account_tick (struct thread *);
+static void mlfqs_second (struct thread *running);
+static void mlfqs_catch_up (struct thread *);
+static int mlfqs_priority (const struct thread *);
+static REAL fixed_pow (REAL x, int64_t n);
+static void ready_push (struct thread *);
+static void ready_remove (struct thread *);
+static struct thread *ready_pop (struct ready_queue *);
+static struct thread *ready_oldest (struct ready_queue *);
+static int aged_priority (const struct thread *, int, int64_t);
+static int ready_max_priority (const struct ready_queue *);
+static void thread_set_ready_priority (struct thread *, int priority);
+static bool stride_less (const struct thread *, const struct thread *);
+static bool edf_less (const struct list_elem *, const struct list_elem *,
+                      void *aux);
+static alarm_func thread_edf_release;
+static void thread_edf_leave (struct thread *);
+static void stride_sift_up (struct ready_queue *, size_t idx);
+static void stride_sift_down (struct ready_queue *, size_t idx);
+static void schedstat_switch_out (struct thread *);
+static void schedstat_switch_in (struct thread *);
+static void schedstat_add (struct schedstat *, enum schedstat_hist,
+                           uint64_t cycles);
+static void schedstat_merge (struct schedstat *, const struct schedstat *);
+static void schedstat_print_hist (const char *name, const uint32_t *);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -104,8 +188,6 @@ thread_init (void)
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
-  list_init (&block_list);
   list_init (&all_list);
 
   /* Set up a thread structure for the running thread. */
@@ -119,25 +201,19 @@ thread_init (void)
   initial_thread->recent_cpu = 0;
 }
 
+/* Alarm function for a sleeping thread T_: wakes it up, and
+   preempts the running thread on return from the timer
+   interrupt if T_ outranks it. */
 static void
-thread_wake(void)
+thread_wake (void *t_)
 {
-  int64_t cur_ticks = timer_ticks();
-  struct list_elem *e = list_begin(&block_list);
+  struct thread *t = t_;
 
-  while (e != list_end(&block_list))
-    {
-      struct thread *t = list_entry(e, struct thread, elem);
-      if (!(t->ticks > cur_ticks))
-        {
-          list_pop_front(&block_list);
-          e = list_begin(&block_list);
-          thread_unblock(t);
-        }
-      else
-        break;
-    }
+  thread_unblock (t);
+  if (thread_preempts (t))
+    intr_yield_on_return ();
 }
+
 /* Starts preemptive thread scheduling by enabling interrupts.
    Also creates the idle thread. */
 void
@@ -145,13 +221,20 @@ thread_start (void)
 {
   /* Create the idle thread. */
   struct semaphore start_idle;
+  unsigned i;
+
+  if (thread_stride)
+    for (i = 0; i < CPU_CNT; i++)
+      cpus[i].rq.heap = palloc_get_multiple (PAL_ASSERT, STRIDE_HEAP_PAGES);
+
   sema_init (&start_idle, 0);
   thread_create ("idle", PRI_MIN, idle, &start_idle);
 
   /* Start preemptive thread scheduling. */
   intr_enable ();
 
-  /* Wait for the idle thread to initialize idle_thread. */
+  /* Wait for the idle thread to initialize our CPU's
+     idle_thread. */
   sema_down (&start_idle);
 }
 
@@ -160,57 +243,153 @@ thread_start (void)
 void
 thread_tick (void) 
 {
-  struct thread *t = thread_current ();
+  struct thread *cur = thread_current ();
+
+  thread_account_tick (cur);
+
+  /* Enforce EDF budgets. */
+  if (cur->edf_period > 0 && ++cur->edf_used >= cur->edf_budget)
+    {
+      cur->edf_throttled = true;
+      intr_yield_on_return ();
+    }
+
+  /* Enforce preemption. */
+  if (++thread_ticks >= TIME_SLICE)
+    {
+      trace_record (TRACE_PREEMPT, thread_current ()->tid, 0, 0, NULL);
+      intr_yield_on_return ();
+    }
+}
 
-  if(t != idle_thread)
+/* Called by the timer interrupt handler in place of
+   thread_tick() for each tick that went by while the CPU idled
+   with the periodic tick stopped (see timer_idle_enter()).  The
+   idle thread was running throughout, so the tick is charged to
+   it, and nothing was ready to preempt or age. */
+void
+thread_tick_idle (void) 
+{
+  thread_account_tick (cpu_current ()->idle_thread);
+}
+
+/* Charges one timer tick to T, the thread that was running
+   during it, and does the MLFQS bookkeeping that falls due on
+   this tick. */
+static void
+thread_account_tick (struct thread *t) 
+{
+  struct cpu *c = cpu_current ();
+
+  if(t != c->idle_thread)
     t->recent_cpu += POINT;
+  if (thread_stride && t != c->idle_thread)
+    t->pass += STRIDE1 / thread_stride_tickets (t);
 
+  /* Only the running thread's recent_cpu changes between the
+     once-per-second updates, so it is the only thread whose
+     priority needs recomputing every fourth tick. */
   if(thread_mlfqs)
     {
     enum intr_level old_level = intr_disable();
-    if(timer_ticks()%4 == 0)
-      {
-        thread_foreach(update_priority, NULL);
-        sort_ready_list();
-      }
     if(timer_ticks()%TIMER_FREQ == 0)
-      {
-        update_load_avg();
-        thread_foreach(update_recent_cpu, NULL);
-      }
+      mlfqs_second(t);
+    else if(timer_ticks()%4 == 0 && t != c->idle_thread)
+      update_priority(t, NULL);
     intr_set_level(old_level);
     }
 
   /* Update statistics. */
-  if (t == idle_thread)
-    idle_ticks++;
+  if (t == c->idle_thread)
+    c->idle_ticks++;
 #ifdef USERPROG
   else if (t->pagedir != NULL)
-    user_ticks++;
+    c->user_ticks++;
 #endif
   else
-    kernel_ticks++;
-
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
-    intr_yield_on_return ();
-
-  /* For project 1 */
-// #ifndef USERPROG
-  thread_wake();
-  if (thread_prior_aging) {
-    age_ticks++;
-    thread_aging();
-  }
-// #endif
+    c->kernel_ticks++;
 }
 
-/* Prints thread statistics. */
+/* Prints thread statistics, summed over all processors. */
 void
 thread_print_stats (void) 
 {
+  long long idle_ticks = 0, kernel_ticks = 0, user_ticks = 0;
+  unsigned i;
+
+  for (i = 0; i < CPU_CNT; i++)
+    {
+      idle_ticks += cpus[i].idle_ticks;
+      kernel_ticks += cpus[i].kernel_ticks;
+      user_ticks += cpus[i].user_ticks;
+    }
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread: %lld page cache hits, %lld misses\n",
+          thread_cache_hits, thread_cache_misses);
+}
+
+/* Prints scheduler latency statistics, summed over every thread
+   that has run, as the median, 99th percentile, and maximum of
+   each histogram.  Each is given as the power of two that
+   bounds its histogram bucket. */
+void
+thread_print_schedstat (void) 
+{
+  struct schedstat sum = schedstat_exited;
+  enum intr_level old_level;
+  struct list_elem *e;
+
+  old_level = intr_disable ();
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    schedstat_merge (&sum, &list_entry (e, struct thread, allelem)->schedstat);
+  intr_set_level (old_level);
+
+  printf ("Sched: %"PRIu32" voluntary, %"PRIu32" involuntary switches\n",
+          sum.voluntary, sum.involuntary);
+  schedstat_print_hist ("wait", sum.hist[SCHEDSTAT_WAIT]);
+  schedstat_print_hist ("run", sum.hist[SCHEDSTAT_RUN]);
+  schedstat_print_hist ("wakeup", sum.hist[SCHEDSTAT_WAKEUP]);
+}
+
+/* Prints a line summarizing histogram HIST, which is called
+   NAME. */
+static void
+schedstat_print_hist (const char *name, const uint32_t *hist) 
+{
+  static const unsigned pcts[] = {50, 99, 100};
+  static const char *labels[] = {"p50", "p99", "max"};
+  uint64_t total = 0, seen;
+  unsigned b, i;
+
+  for (b = 0; b < SCHEDSTAT_BUCKETS; b++)
+    total += hist[b];
+  printf ("Sched: %-6s %8"PRIu64" samples", name, total);
+  if (total == 0)
+    {
+      putchar ('\n');
+      return;
+    }
+
+  /* Find the first bucket at which PCTS[I] percent of the
+     samples have been seen. */
+  seen = 0;
+  b = 0;
+  for (i = 0; i < sizeof pcts / sizeof *pcts; i++)
+    {
+      for (; b < SCHEDSTAT_BUCKETS; b++)
+        if ((seen + hist[b]) * 100 >= total * pcts[i])
+          break;
+        else
+          seen += hist[b];
+      if (b < SCHEDSTAT_BUCKETS - 1)
+        printf (", %s < 2^%u", labels[i], SCHEDSTAT_SHIFT + b);
+      else
+        printf (", %s >= 2^%u", labels[i],
+                SCHEDSTAT_SHIFT + SCHEDSTAT_BUCKETS - 2);
+    }
+  printf (" cycles\n");
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -242,7 +421,7 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = thread_page_get ();
   if (t == NULL)
     return TID_ERROR;
 
@@ -278,9 +457,10 @@ thread_create (const char *name, int priority,
   list_push_back (&cur->child_list,
                   &t->child_elem);
 
-  /* inherit parent's nice & recent_cpu */
+  /* inherit parent's nice & recent_cpu, and tickets */
   t->nice = cur->nice;
   t->recent_cpu = cur->recent_cpu;
+  t->tickets = cur->tickets;
 
   /* Add to run queue. */
   thread_unblock (t);
@@ -324,10 +504,20 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  // XXX : list_insert_ordered!
-  //  list_push_back (&ready_list, &t->elem);
-  list_insert_ordered(&ready_list, &t->elem, ready_less, NULL);
+  if (thread_mlfqs)
+    {
+      mlfqs_catch_up (t);
+      t->priority = mlfqs_priority (t);
+    }
   t->status = THREAD_READY;
+  t->cpu = cpu_current ();
+  if (t->pass < t->cpu->rq.pass)
+    t->pass = t->cpu->rq.pass;
+  t->sched_stamp = rdtsc ();
+  t->sched_woken = true;
+  t->ready_tick = timer_ticks ();
+  ready_push (t);
+  trace_record (TRACE_WAKEUP, t->tid, running_thread ()->tid, 0, NULL);
   intr_set_level (old_level);
 }
 
@@ -379,6 +569,7 @@ thread_exit (void)
      and schedule another process.  That process will destroy us
      when it calls thread_schedule_tail(). */
   intr_disable ();
+  thread_edf_leave (thread_current ());
   list_remove (&thread_current()->allelem);
   thread_current ()->status = THREAD_DYING;
   schedule ();
@@ -396,14 +587,73 @@ thread_yield (void)
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
-  if (cur != idle_thread) 
-    // XXX : list_push_back (&ready_list, &cur->elem);
-    list_insert_ordered(&ready_list, &cur->elem, ready_less, NULL);
-  cur->status = THREAD_READY;
+  if (cur->edf_throttled)
+    {
+      /* Out of EDF budget: sit out the rest of the period. */
+      cur->edf_parked = true;
+      cur->status = THREAD_BLOCKED;
+    }
+  else
+    {
+      cur->status = THREAD_READY;
+      cur->ready_tick = timer_ticks ();
+      if (cur != cur->cpu->idle_thread) 
+        ready_push (cur);
+    }
   schedule ();
   intr_set_level (old_level);
 }
 
+/* Keeps the running thread from being preempted by an interrupt
+   handler's request to yield, until the matching call to
+   thread_preempt_enable().  Calls nest.  Used by spinlocks, so
+   that a thread spinning on a lock cannot be the one keeping its
+   preempted holder off the CPU.  Interrupts are still taken. */
+void
+thread_preempt_disable (void) 
+{
+  cpu_current ()->preempt_cnt++;
+  barrier ();
+}
+
+/* Undoes one thread_preempt_disable().  When the last one is
+   undone, yields if an interrupt asked for a preemption in the
+   meantime, unless interrupts are off, in which case the
+   preemption waits for the next interrupt to ask again. */
+void
+thread_preempt_enable (void) 
+{
+  struct cpu *c = cpu_current ();
+
+  ASSERT (c->preempt_cnt > 0);
+
+  barrier ();
+  if (--c->preempt_cnt == 0 && c->preempt_pending
+      && !intr_context () && intr_get_level () == INTR_ON)
+    {
+      c->preempt_pending = false;
+      thread_yield ();
+    }
+}
+
+/* Called on return from an interrupt handler that requested a
+   yield.  Returns true if the running thread may be preempted
+   now.  Otherwise, remembers that a preemption is pending, for
+   thread_preempt_enable() to carry out, and returns false. */
+bool
+thread_preempt_check (void) 
+{
+  struct cpu *c = cpu_current ();
+
+  if (c->preempt_cnt > 0)
+    {
+      c->preempt_pending = true;
+      return false;
+    }
+  c->preempt_pending = false;
+  return true;
+}
+
 /* Invoke function 'func' on all threads, passing along 'aux'.
    This function must be called with interrupts off. */
 void
@@ -421,12 +671,21 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
+/* Puts the running thread to sleep until the timer reaches tick
+   WAKEUP.  Arming the thread's alarm is O(1); the timer
+   interrupt wakes the thread when the alarm goes off.
+
+   This function must be called with interrupts turned off. */
 void
-thread_sleep(int64_t ticks)
+thread_sleep (int64_t wakeup)
 {
-  struct thread *cur = thread_current();
-  cur->ticks = ticks;
-  list_insert_ordered(&block_list, &cur->elem, block_less, NULL);
+  struct thread *cur = thread_current ();
+
+  ASSERT (!intr_context ());
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  alarm_set (&cur->sleep_alarm, wakeup, 0);
+  thread_block ();
 }
 
 /* Returns the current thread's priority. */
@@ -440,28 +699,63 @@ thread_get_priority (void)
 void
 thread_set_priority (int new_priority) 
 {
-  thread_current ()->priority = new_priority;
-  thread_yield();
+  thread_set_priority_of (thread_current (), new_priority);
+}
+
+/* Sets T's base priority to NEW_PRIORITY and yields if T is now
+   the running thread or a ready thread that should preempt it. */
+void
+thread_set_priority_of (struct thread *t, int new_priority) 
+{
+  enum intr_level old_level;
+
+  ASSERT (is_thread (t));
+  ASSERT (PRI_MIN <= new_priority && new_priority <= PRI_MAX);
+
+  old_level = intr_disable ();
+  t->base_priority = new_priority;
+  if (thread_mlfqs)
+    thread_set_ready_priority (t, new_priority);
+  else
+    thread_refresh_priority (t);
+  if (t == thread_current ()
+      || (t->status == THREAD_READY && thread_preempts (t)))
+    thread_yield ();
+  intr_set_level (old_level);
 }
 
 /* Sets the current thread's nice value to NICE. */
 void
 thread_set_nice (int new_nice) 
 {
-  if(new_nice < -20)
-    new_nice = -20;
-  if(new_nice > 20)
-    new_nice = 20;
-  thread_current()->nice = new_nice;
+  thread_set_nice_of (thread_current (), new_nice);
+}
 
-  enum intr_level old_level = intr_disable();
-  thread_foreach(update_priority, NULL);
-  intr_set_level(old_level);
-  sort_ready_list();
+/* Sets T's nice value to NEW_NICE, clamped to NICE_MIN...NICE_MAX.
+   In MLFQS mode T's priority is recomputed at once, yielding if
+   a ready thread now outranks the running one. */
+void
+thread_set_nice_of (struct thread *t, int new_nice) 
+{
+  enum intr_level old_level;
 
-  int highest_prty = list_entry(list_begin(&ready_list), struct thread, elem)->priority;
-  if(thread_current()->priority < highest_prty)
-    thread_yield();
+  ASSERT (is_thread (t));
+
+  if (new_nice < NICE_MIN)
+    new_nice = NICE_MIN;
+  if (new_nice > NICE_MAX)
+    new_nice = NICE_MAX;
+
+  old_level = intr_disable ();
+  t->nice = new_nice;
+  if (thread_mlfqs)
+    {
+      update_priority (t, NULL);
+      if (thread_current ()->priority
+          < ready_max_priority (&cpu_current ()->rq))
+        thread_yield ();
+    }
+  intr_set_level (old_level);
 }
 
 /* Returns the current thread's nice value. */
@@ -503,20 +797,191 @@ thread_get_recent_cpu (void)
   return thread_current()->recent_cpu*100 / POINT;
 }
 
+/* Returns the current thread's stride scheduling tickets. */
+int
+thread_get_tickets (void) 
+{
+  return thread_current ()->tickets;
+}
+
+/* Sets the current thread's stride scheduling tickets to
+   TICKETS, clamped to TICKETS_MIN...TICKETS_MAX. */
+void
+thread_set_tickets (int tickets) 
+{
+  if (tickets < TICKETS_MIN)
+    tickets = TICKETS_MIN;
+  if (tickets > TICKETS_MAX)
+    tickets = TICKETS_MAX;
+  thread_current ()->tickets = tickets;
+}
+
+/* Puts the running thread in the earliest-deadline-first class,
+   to be released every PERIOD ticks with a BUDGET-tick job due
+   by the next release.  The first period starts now.  Returns
+   false, changing nothing, if BUDGET is not between 1 and
+   PERIOD, or if admitting the thread would reserve more than the
+   whole CPU for EDF threads.  A PERIOD of 0 takes the thread
+   back out of the EDF class. */
+bool
+thread_set_deadline (int64_t period, int64_t budget) 
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  int util = 0;
+
+  ASSERT (!intr_context ());
+
+  if (period < 0 || (period > 0 && (budget < 1 || budget > period)))
+    return false;
+  if (period > 0)
+    util = DIV_ROUND_UP (budget * EDF_UTIL_SCALE, period);
+
+  old_level = intr_disable ();
+  if (edf_util - cur->edf_util + util > EDF_UTIL_SCALE)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  thread_edf_leave (cur);
+  if (period > 0)
+    {
+      edf_util += util;
+      cur->edf_util = util;
+      cur->edf_period = period;
+      cur->edf_budget = budget;
+      cur->edf_deadline = timer_ticks () + period;
+      alarm_set (&cur->edf_alarm, cur->edf_deadline, period);
+    }
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Ends the running EDF thread's job for this period and blocks
+   it until its next release. */
+void
+thread_edf_next_period (void) 
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (cur->edf_period > 0);
+
+  old_level = intr_disable ();
+  cur->edf_done = true;
+  cur->edf_parked = true;
+  thread_block ();
+  intr_set_level (old_level);
+}
+
+/* Returns the number of deadlines the running thread has missed
+   since it last joined the EDF class. */
+int
+thread_edf_misses (void) 
+{
+  return thread_current ()->edf_misses;
+}
+
+/* Returns true if T, which was just made ready, should run in
+   place of the running thread: T is in the EDF class and the
+   running thread is not or has a later deadline, or neither is
+   in the EDF class and T has higher priority. */
+bool
+thread_preempts (const struct thread *t) 
+{
+  const struct thread *cur = thread_current ();
+
+  if (t->edf_period > 0 || cur->edf_period > 0)
+    return t->edf_period > 0
+           && (cur->edf_period == 0 || t->edf_deadline < cur->edf_deadline);
+  return t->priority > cur->priority;
+}
+
+/* Alarm function for T's EDF releases.  Starts T's next period,
+   counting a missed deadline if T did not finish the job for
+   the last one, and wakes T if it was parked. */
+static void
+thread_edf_release (void *t_) 
+{
+  struct thread *t = t_;
+
+  if (!t->edf_done)
+    t->edf_misses++;
+  t->edf_done = false;
+  t->edf_used = 0;
+  t->edf_throttled = false;
+
+  /* The alarm has already been re-armed for the next release,
+     which is this period's deadline.  A ready T must be moved to
+     its new place in the deadline order. */
+  if (t->status == THREAD_READY)
+    ready_remove (t);
+  t->edf_deadline = t->edf_alarm.expires;
+  if (t->status == THREAD_READY)
+    ready_push (t);
+
+  if (t->edf_parked)
+    {
+      t->edf_parked = false;
+      thread_unblock (t);
+    }
+  if (t != thread_current () && thread_preempts (t))
+    intr_yield_on_return ();
+}
+
+/* Takes T out of the EDF class, giving back its reserved
+   utilization.  Interrupts must be off. */
+static void
+thread_edf_leave (struct thread *t) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  alarm_cancel (&t->edf_alarm);
+  edf_util -= t->edf_util;
+  t->edf_util = 0;
+  t->edf_period = t->edf_budget = t->edf_used = 0;
+  t->edf_done = t->edf_throttled = t->edf_parked = false;
+  t->edf_misses = 0;
+}
+
+/* Returns true if the deadline of the thread at A is earlier
+   than that of the thread at B. */
+static bool
+edf_less (const struct list_elem *a, const struct list_elem *b,
+          void *aux UNUSED) 
+{
+  return list_entry (a, struct thread, elem)->edf_deadline
+         < list_entry (b, struct thread, elem)->edf_deadline;
+}
+
+/* Returns the tickets T runs with: its own, plus those lent to
+   it through the locks it holds. */
+int
+thread_stride_tickets (struct thread *t) 
+{
+  struct list_elem *e;
+  int tickets = t->tickets;
+
+  for (e = list_begin (&t->locks); e != list_end (&t->locks);
+       e = list_next (e))
+    tickets += list_entry (e, struct lock, elem)->tickets;
+  return tickets;
+}
+
 /* Idle thread.  Executes when no other thread is ready to run.
 
    The idle thread is initially put on the ready list by
    thread_start().  It will be scheduled once initially, at which
-   point it initializes idle_thread, "up"s the semaphore passed
-   to it to enable thread_start() to continue, and immediately
-   blocks.  After that, the idle thread never appears in the
+   point it initializes its CPU's idle_thread, "up"s the semaphore
+   passed to it to enable thread_start() to continue, and
+   immediately blocks.  After that, the idle thread never appears in the
    ready list.  It is returned by next_thread_to_run() as a
-   special case when the ready list is empty. */
+   special case when the run queues are empty. */
 static void
 idle (void *idle_started_ UNUSED) 
 {
   struct semaphore *idle_started = idle_started_;
-  idle_thread = thread_current ();
+  cpu_current ()->idle_thread = thread_current ();
   sema_up (idle_started);
 
   for (;;) 
@@ -525,6 +990,10 @@ idle (void *idle_started_ UNUSED)
       intr_disable ();
       thread_block ();
 
+      /* In tickless mode, stop the periodic timer tick until
+         the next alarm is due. */
+      timer_idle_enter ();
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -587,6 +1056,13 @@ init_thread (struct thread *t, const char *name, int priority)
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
   t->priority = priority;
+  t->base_priority = priority;
+  t->cpu = cpu_current ();
+  list_init (&t->locks);
+  t->decay_epoch = decay_epoch;
+  t->tickets = TICKETS_DEFAULT;
+  alarm_init (&t->edf_alarm, thread_edf_release, t);
+  t->sched_stamp = rdtsc ();
   t->magic = THREAD_MAGIC;
 
   list_push_back (&all_list, &t->allelem);
@@ -594,8 +1070,8 @@ init_thread (struct thread *t, const char *name, int priority)
   sema_init (&t->load_sema, 0);
   sema_init (&t->exec_sema, 0);
   sema_init (&t->wait_sema, 0);
-  list_init (&t->filelist);
   t->cur_file = NULL;
+  alarm_init (&t->sleep_alarm, thread_wake, t);
 }
 
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
@@ -608,21 +1084,341 @@ alloc_frame (struct thread *t, size_t size)
   ASSERT (size % sizeof (uint32_t) == 0);
 
   t->stack -= size;
+  memset (t->stack, 0, size);
   return t->stack;
 }
 
+/* Returns a page for a new thread, from the cache of pages of
+   exited threads if possible.  Only the parts of the page that
+   init_thread() and alloc_frame() initialize may be assumed to
+   hold anything in particular.  Returns a null pointer if no
+   memory is available. */
+static struct thread *
+thread_page_get (void) 
+{
+  enum intr_level old_level;
+  void **page;
+
+  old_level = intr_disable ();
+  page = thread_cache;
+  if (page != NULL)
+    {
+      thread_cache = *page;
+      thread_cache_cnt--;
+      thread_cache_hits++;
+    }
+  else
+    thread_cache_misses++;
+  intr_set_level (old_level);
+
+  if (page == NULL)
+    page = palloc_get_page (0);
+  return (struct thread *) page;
+}
+
+/* Frees the page of exited thread T, keeping it in the cache if
+   there is room.  Interrupts must be off. */
+static void
+thread_page_put (struct thread *t) 
+{
+  void **page = (void **) t;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_cache_cnt < thread_cache_size)
+    {
+      *page = thread_cache;
+      thread_cache = page;
+      thread_cache_cnt++;
+    }
+  else
+    palloc_free_page (t);
+}
+
 /* Chooses and returns the next thread to be scheduled.  Should
    return a thread from the run queue, unless the run queue is
    empty.  (If the running thread can continue running, then it
    will be in the run queue.)  If the run queue is empty, return
-   idle_thread. */
+   the CPU's idle_thread. */
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
-    return idle_thread;
+  struct cpu *c = cpu_current ();
+
+  if (c->rq.cnt == 0)
+    return c->idle_thread;
+  else
+    return ready_pop (&c->rq);
+}
+
+/* Appends T, which must be in THREAD_READY state, to the run
+   queue for its priority on T's CPU, or under stride scheduling
+   adds it to the CPU's heap.  EDF threads go into the CPU's EDF
+   queue instead, in deadline order.  With aging, each queue is
+   kept in order of ready_tick, so that its front thread is the
+   one that has waited longest; T almost always became ready
+   last, so the search from the back stops at once.  Interrupts
+   must be off. */
+static void
+ready_push (struct thread *t)
+{
+  struct ready_queue *rq = &t->cpu->rq;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_READY);
+  ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+  if (t->edf_period > 0)
+    {
+      list_insert_ordered (&rq->edf, &t->elem, edf_less, NULL);
+      rq->cnt++;
+      return;
+    }
+  if (thread_stride)
+    {
+      ASSERT (rq->heap_cnt < STRIDE_HEAP_MAX);
+      rq->heap[rq->heap_cnt] = t;
+      t->heap_idx = rq->heap_cnt;
+      stride_sift_up (rq, rq->heap_cnt++);
+      rq->cnt++;
+      return;
+    }
+
+  if (thread_prior_aging)
+    {
+      struct list *q = &rq->queues[t->priority];
+      struct list_elem *e = list_rbegin (q);
+
+      while (e != list_rend (q)
+             && list_entry (e, struct thread, elem)->ready_tick > t->ready_tick)
+        e = list_prev (e);
+      list_insert (list_next (e), &t->elem);
+    }
+  else
+    list_push_back (&rq->queues[t->priority], &t->elem);
+  rq->bitmap[t->priority / 32] |= 1u << (t->priority % 32);
+  rq->cnt++;
+}
+
+/* Removes T from the run queue for its priority, the stride
+   heap, or the EDF queue on T's CPU.  Interrupts must be off. */
+static void
+ready_remove (struct thread *t)
+{
+  struct ready_queue *rq = &t->cpu->rq;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_READY);
+
+  if (t->edf_period > 0)
+    {
+      list_remove (&t->elem);
+      rq->cnt--;
+      return;
+    }
+  if (thread_stride)
+    {
+      /* Fill T's slot with the last thread, then restore the
+         heap order around it. */
+      size_t idx = t->heap_idx;
+
+      ASSERT (rq->heap[idx] == t);
+      if (idx != --rq->heap_cnt)
+        {
+          rq->heap[idx] = rq->heap[rq->heap_cnt];
+          rq->heap[idx]->heap_idx = idx;
+          stride_sift_up (rq, idx);
+          stride_sift_down (rq, rq->heap[idx]->heap_idx);
+        }
+      rq->cnt--;
+      return;
+    }
+
+  list_remove (&t->elem);
+  if (list_empty (&rq->queues[t->priority]))
+    rq->bitmap[t->priority / 32] &= ~(1u << (t->priority % 32));
+  rq->cnt--;
+}
+
+/* Removes and returns the ready EDF thread with the earliest
+   deadline in RQ.  If there is none, removes and returns the
+   thread at the front of the highest nonempty queue, or under
+   stride scheduling the thread with the lowest pass.  With
+   aging, a queue's rank is instead its priority plus the ticks
+   its front thread has waited, and the chosen thread keeps the
+   promotion.  At least one thread must be ready. */
+static struct thread *
+ready_pop (struct ready_queue *rq)
+{
+  int priority;
+  struct thread *t;
+
+  if (!list_empty (&rq->edf))
+    {
+      t = list_entry (list_front (&rq->edf), struct thread, elem);
+      ready_remove (t);
+      return t;
+    }
+  if (thread_stride)
+    {
+      ASSERT (rq->heap_cnt > 0);
+      t = rq->heap[0];
+      ready_remove (t);
+      if (rq->pass < t->pass)
+        rq->pass = t->pass;
+      return t;
+    }
+
+  if (thread_prior_aging)
+    {
+      t = ready_oldest (rq);
+      ready_remove (t);
+      thread_age (t);
+      return t;
+    }
+
+  priority = ready_max_priority (rq);
+  ASSERT (priority >= PRI_MIN);
+
+  t = list_entry (list_front (&rq->queues[priority]), struct thread, elem);
+  ready_remove (t);
+  return t;
+}
+
+/* Returns T's priority raised by one level for each tick it has
+   been ready, saturating at PRI_MAX. */
+static int
+aged_priority (const struct thread *t, int priority, int64_t now) 
+{
+  int64_t waited = now - t->ready_tick;
+
+  return waited >= PRI_MAX - priority ? PRI_MAX : priority + waited;
+}
+
+/* Returns the thread in RQ's priority queues with the highest
+   aged priority, preferring the one that has waited longest on
+   a tie.  Only the front of each nonempty queue can win, because
+   ready_push() keeps each queue in order of ready_tick, so the
+   cost is bounded by the number of levels rather than the
+   number of ready threads.  At least one queue must be
+   nonempty. */
+static struct thread *
+ready_oldest (struct ready_queue *rq) 
+{
+  int64_t now = timer_ticks ();
+  struct thread *best = NULL;
+  int best_priority = -1;
+  int i;
+
+  for (i = READY_WORDS - 1; i >= 0; i--)
+    {
+      uint32_t bits = rq->bitmap[i];
+
+      while (bits != 0)
+        {
+          int bit = 31 - __builtin_clz (bits);
+          int level = i * 32 + bit;
+          struct thread *t = list_entry (list_front (&rq->queues[level]),
+                                         struct thread, elem);
+          int priority = aged_priority (t, level, now);
+
+          if (priority > best_priority
+              || (priority == best_priority
+                  && t->ready_tick < best->ready_tick))
+            {
+              best = t;
+              best_priority = priority;
+            }
+          bits &= ~(1u << bit);
+        }
+    }
+  ASSERT (best != NULL);
+  return best;
+}
+
+/* Returns true if thread A should run before thread B under
+   stride scheduling: it has the lower pass or, on a tie, the
+   lower tid. */
+static bool
+stride_less (const struct thread *a, const struct thread *b) 
+{
+  return a->pass < b->pass || (a->pass == b->pass && a->tid < b->tid);
+}
+
+/* Moves the thread at IDX in RQ's stride heap up toward the
+   root until its parent runs before it. */
+static void
+stride_sift_up (struct ready_queue *rq, size_t idx) 
+{
+  struct thread *t = rq->heap[idx];
+
+  while (idx > 0 && stride_less (t, rq->heap[(idx - 1) / 2]))
+    {
+      rq->heap[idx] = rq->heap[(idx - 1) / 2];
+      rq->heap[idx]->heap_idx = idx;
+      idx = (idx - 1) / 2;
+    }
+  rq->heap[idx] = t;
+  t->heap_idx = idx;
+}
+
+/* Moves the thread at IDX in RQ's stride heap down toward the
+   leaves until it runs before both of its children. */
+static void
+stride_sift_down (struct ready_queue *rq, size_t idx) 
+{
+  struct thread *t = rq->heap[idx];
+
+  for (;;)
+    {
+      size_t child = 2 * idx + 1;
+
+      if (child >= rq->heap_cnt)
+        break;
+      if (child + 1 < rq->heap_cnt
+          && stride_less (rq->heap[child + 1], rq->heap[child]))
+        child++;
+      if (!stride_less (rq->heap[child], t))
+        break;
+      rq->heap[idx] = rq->heap[child];
+      rq->heap[idx]->heap_idx = idx;
+      idx = child;
+    }
+  rq->heap[idx] = t;
+  t->heap_idx = idx;
+}
+
+/* Returns the priority of the highest nonempty queue in RQ, or
+   -1 if no thread is ready. */
+static int
+ready_max_priority (const struct ready_queue *rq)
+{
+  int i;
+
+  for (i = READY_WORDS - 1; i >= 0; i--)
+    if (rq->bitmap[i] != 0)
+      return i * 32 + 31 - __builtin_clz (rq->bitmap[i]);
+  return -1;
+}
+
+/* Sets T's priority to PRIORITY, moving T to the matching run
+   queue if it is ready.  Interrupts must be off. */
+static void
+thread_set_ready_priority (struct thread *t, int priority)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->priority == priority)
+    return;
+  if (t->status == THREAD_READY && t != t->cpu->idle_thread
+      && !thread_stride)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_push (t);
+    }
   else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+    t->priority = priority;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -650,6 +1446,8 @@ thread_schedule_tail (struct thread *prev)
 
   /* Mark us as running. */
   cur->status = THREAD_RUNNING;
+  if (prev != NULL)
+    schedstat_switch_in (cur);
 
   /* Start new time slice. */
   thread_ticks = 0;
@@ -664,10 +1462,12 @@ thread_schedule_tail (struct thread *prev)
      pull out the rug under itself.  (We don't free
      initial_thread because its memory was not obtained via
      palloc().) */
-  if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
+  if (prev != NULL && prev->status == THREAD_DYING)
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      schedstat_merge (&schedstat_exited, &prev->schedstat);
+      if (prev != initial_thread)
+        thread_page_put (prev);
     }
 }
 
@@ -688,12 +1488,85 @@ schedule (void)
   ASSERT (intr_get_level () == INTR_OFF);
   ASSERT (cur->status != THREAD_RUNNING);
   ASSERT (is_thread (next));
+  ASSERT (cur->cpu->preempt_cnt == 0);
+
+  /* Bring the timer back from tickless idle before anyone else
+     runs. */
+  if (cur == cur->cpu->idle_thread && next != cur->cpu->idle_thread)
+    timer_idle_exit ();
 
   if (cur != next)
-    prev = switch_threads (cur, next);
+    {
+      trace_record (TRACE_SWITCH, cur->tid, next->tid, cur->status, NULL);
+      schedstat_switch_out (cur);
+      prev = switch_threads (cur, next);
+    }
   thread_schedule_tail (prev);
 }
 
+/* Accounts for running thread CUR being switched out by
+   schedule(), having already left the THREAD_RUNNING state. */
+static void
+schedstat_switch_out (struct thread *cur) 
+{
+  uint64_t now = rdtsc ();
+
+  if (cur != cur->cpu->idle_thread)
+    {
+      schedstat_add (&cur->schedstat, SCHEDSTAT_RUN, now - cur->sched_stamp);
+      if (cur->status == THREAD_READY)
+        cur->schedstat.involuntary++;
+      else
+        cur->schedstat.voluntary++;
+    }
+  cur->sched_stamp = now;
+}
+
+/* Accounts for thread CUR being switched in by schedule(). */
+static void
+schedstat_switch_in (struct thread *cur) 
+{
+  uint64_t now = rdtsc ();
+
+  if (cur != cur->cpu->idle_thread)
+    {
+      schedstat_add (&cur->schedstat, SCHEDSTAT_WAIT, now - cur->sched_stamp);
+      if (cur->sched_woken)
+        schedstat_add (&cur->schedstat, SCHEDSTAT_WAKEUP,
+                       now - cur->sched_stamp);
+    }
+  cur->sched_woken = false;
+  cur->sched_stamp = now;
+}
+
+/* Counts an interval of CYCLES in histogram HIST of S. */
+static void
+schedstat_add (struct schedstat *s, enum schedstat_hist hist,
+               uint64_t cycles) 
+{
+  unsigned b = 0;
+
+  while (cycles >= (1u << SCHEDSTAT_SHIFT) && b < SCHEDSTAT_BUCKETS - 1)
+    {
+      cycles >>= 1;
+      b++;
+    }
+  s->hist[hist][b]++;
+}
+
+/* Adds the statistics in SRC to those in DST. */
+static void
+schedstat_merge (struct schedstat *dst, const struct schedstat *src) 
+{
+  unsigned h, b;
+
+  for (h = 0; h < SCHEDSTAT_HIST_CNT; h++)
+    for (b = 0; b < SCHEDSTAT_BUCKETS; b++)
+      dst->hist[h][b] += src->hist[h][b];
+  dst->voluntary += src->voluntary;
+  dst->involuntary += src->involuntary;
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void) 
@@ -708,58 +1581,152 @@ allocate_tid (void)
   return tid;
 }
 
+/* File descriptors per page of a process's fd table, and the
+   most pages the table may grow to. */
+#define FDS_PER_PAGE ((int) (PGSIZE / sizeof (struct file *)))
+#define FD_PAGES_MAX 8
+
+/* Grows FDS by one page, copying over the old contents.  Returns
+   true if successful, false if it is already at its largest or
+   memory is short. */
 static bool
-taf_less (const struct list_elem *a, const struct list_elem *b, void* aux UNUSED)
+fd_table_grow (struct fd_table *fds)
 {
-  return list_entry(a, struct file_list, ptr)->fd
-   < list_entry(b, struct file_list, ptr)->fd;
+  size_t pages = fds->cap / FDS_PER_PAGE + 1;
+  int cap = pages * FDS_PER_PAGE;
+  struct file **files;
+  uint32_t *used;
+
+  if (pages > FD_PAGES_MAX)
+    return false;
+  files = palloc_get_multiple (PAL_ZERO, pages);
+  used = calloc (cap / 32, sizeof *used);
+  if (files == NULL || used == NULL)
+    {
+      if (files != NULL)
+        palloc_free_multiple (files, pages);
+      free (used);
+      return false;
+    }
+
+  if (fds->cap == 0)
+    used[0] = 0x3;              /* The console's fds 0 and 1. */
+  else
+    {
+      memcpy (files, fds->files, fds->cap * sizeof *files);
+      memcpy (used, fds->used, fds->cap / 32 * sizeof *used);
+      palloc_free_multiple (fds->files, pages - 1);
+      free (fds->used);
+    }
+  fds->files = files;
+  fds->used = used;
+  fds->cap = cap;
+  return true;
 }
 
+/* Gives FILE the lowest free descriptor in the running process
+   and returns it, or -1 if none can be had. */
 int
 thread_add_file (struct file *file)
 {
-  struct thread* cur = thread_current();
-  int fd = 2; // 0 : stdin, 1 : stdout, pintos does not use stderr
-  struct list_elem *e;
+  struct fd_table *fds = &thread_current ()->fds;
+  int w, fd;
 
-  /* find a file descriptor that doesn't allocated */
-  for (e = list_begin(&cur->filelist); e != list_end(&cur->filelist);
-       e = list_next(e))
+  for (w = 0; ; w++)
     {
-      if (fd == list_entry(e, struct file_list, ptr)->fd)
-        ++fd;
-      else
+      if (w == fds->cap / 32 && !fd_table_grow (fds))
+        return -1;
+      if (fds->used[w] != UINT32_MAX)
         break;
     }
-  if (fd >= 128)
-    return -1;
+  fd = w * 32 + __builtin_ctz (~fds->used[w]);
+  fds->used[w] |= 1u << (fd % 32);
+  fds->files[fd] = file;
+  return fd;
+}
+
+/* Returns the running process's file for descriptor FD, or a
+   null pointer if FD is not open. */
+struct file *
+thread_get_file (int fd)
+{
+  struct fd_table *fds = &thread_current ()->fds;
 
-  struct file_list *fl = malloc (sizeof(struct file_list));
-  fl->fd = fd;
-  fl->file = file;
+  return fd >= 0 && fd < fds->cap ? fds->files[fd] : NULL;
+}
 
-  list_insert_ordered (&cur->filelist, &fl->ptr, taf_less, NULL);
+/* Frees descriptor FD in the running process and returns the
+   file it referred to, which the caller must close, or a null
+   pointer if FD was not open. */
+struct file *
+thread_remove_file (int fd)
+{
+  struct fd_table *fds = &thread_current ()->fds;
+  struct file *file = thread_get_file (fd);
 
-  return fd;
+  if (file != NULL)
+    {
+      fds->files[fd] = NULL;
+      fds->used[fd / 32] &= ~(1u << (fd % 32));
+    }
+  return file;
 }
 
-static void
-thread_aging (void)
+/* Releases T's fd table.  Any files still in it are not closed. */
+void
+thread_free_files (struct thread *t)
 {
-  struct list_elem*e;
-  for (e = list_begin(&ready_list); e!= list_end(&ready_list);
-       e = list_next(e))
+  struct fd_table *fds = &t->fds;
+
+  if (fds->cap > 0)
     {
-      struct thread *t = list_entry(e, struct thread, elem);
-      t->priority ++;
+      palloc_free_multiple (fds->files, fds->cap / FDS_PER_PAGE);
+      free (fds->used);
+      fds->files = NULL;
+      fds->used = NULL;
+      fds->cap = 0;
     }
 }
 
-bool
-block_less (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+/* Folds the promotion that T earned by waiting in the run queue
+   into its priority, just after it was chosen to run.  The base
+   priority moves along with it, so that the promotion survives
+   the return of any donation the thread is holding. */
+static void
+thread_age (struct thread *t)
+{
+  int64_t now = timer_ticks ();
+
+  t->base_priority = aged_priority (t, t->base_priority, now);
+  t->priority = aged_priority (t, t->priority, now);
+  t->ready_tick = now;
+}
+
+/* Recomputes T's effective priority as the higher of its base
+   priority and the highest priority donated through any lock it
+   holds, moving T to the matching run queue if it is ready.
+   Not used in MLFQS mode, where priorities are computed. */
+void
+thread_refresh_priority (struct thread *t)
 {
-  return list_entry(a, struct thread, elem)->ticks
-   < list_entry(b, struct thread, elem)->ticks;
+  enum intr_level old_level;
+  struct list_elem *e;
+  int priority;
+
+  ASSERT (is_thread (t));
+  ASSERT (!thread_mlfqs);
+
+  old_level = intr_disable ();
+  priority = t->base_priority;
+  for (e = list_begin (&t->locks); e != list_end (&t->locks);
+       e = list_next (e))
+    {
+      struct lock *l = list_entry (e, struct lock, elem);
+      if (l->priority > priority)
+        priority = l->priority;
+    }
+  thread_set_ready_priority (t, priority);
+  intr_set_level (old_level);
 }
 
 bool
@@ -769,35 +1736,154 @@ ready_less (const struct list_elem *a, const struct list_elem *b, void *aux UNUS
    list_entry(b, struct thread, elem)->priority;
 }
 
+/* Returns true if thread A has lower priority than thread B.
+   Used with list_max(), which picks the earliest of equals, so
+   that waiters of the same priority are served in FIFO order. */
+bool
+thread_priority_less (const struct list_elem *a, const struct list_elem *b,
+                      void *aux UNUSED)
+{
+  return list_entry (a, struct thread, elem)->priority
+         < list_entry (b, struct thread, elem)->priority;
+}
+
+/* Returns T's MLFQS priority, computed from its recent_cpu and
+   nice values and clamped to PRI_MIN...PRI_MAX. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+  REAL temp_prty = PRI_MAX*POINT - (t->recent_cpu)/4 - (t->nice)*2*POINT;
+  int priority = temp_prty / POINT;
+
+  if (priority < PRI_MIN)
+    priority = PRI_MIN;
+  else if (priority > PRI_MAX)
+    priority = PRI_MAX;
+  return priority;
+}
+
 void
 update_priority(struct thread *t, void *aux UNUSED)
 {
-  REAL temp_prty = PRI_MAX*POINT - (t->recent_cpu)/4 - (t->nice)*2*POINT;
-  t->priority = temp_prty / POINT;
+  thread_set_ready_priority (t, mlfqs_priority (t));
 }
 
+/* Applies the latest once-per-second decay to T's recent_cpu.
+   Uses the coefficient computed once for this second by
+   mlfqs_second(), so this is a multiply and a shift. */
 void 
 update_recent_cpu(struct thread *t, void *aux UNUSED)
 {
-  REAL temp = ((int64_t)(2*load_avg))*POINT / (2*load_avg + POINT);
-  REAL temp2 = ((int64_t)temp) * (t->recent_cpu) / POINT;
-  REAL temp3 = temp2 + (t->nice)*POINT;
-  t->recent_cpu = temp3;
+  REAL coef = decay_coef[decay_epoch % DECAY_HISTORY];
+
+  t->recent_cpu = ((int64_t) coef) * t->recent_cpu / POINT
+                  + t->nice * POINT;
+  t->decay_epoch = decay_epoch;
 }
 
 void 
 update_load_avg(void)
 {
-  int32_t ready_threads = list_size(&ready_list);
-  if(thread_current() != idle_thread)
+  int32_t ready_threads = 0;
+  unsigned i;
+
+  for (i = 0; i < CPU_CNT; i++)
+    ready_threads += cpus[i].rq.cnt;
+  if(thread_current() != cpu_current ()->idle_thread)
     ready_threads += 1;
   load_avg = (59*load_avg + ready_threads*POINT) / 60;
 }
 
-void
-sort_ready_list(void)
+/* Once-per-second MLFQS update, with RUNNING the thread that was
+   running during the tick just ended.  Updates load_avg and
+   computes this second's decay coefficient, then decays
+   recent_cpu and recomputes the priority of RUNNING and of every
+   ready thread.  Blocked threads are left alone. */
+static void
+mlfqs_second (struct thread *running)
 {
-  list_sort(&ready_list,ready_less,NULL);
+  struct ready_queue *rq = &cpu_current ()->rq;
+  struct list ready;
+  int p;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  update_load_avg ();
+  decay_epoch++;
+  decay_load[decay_epoch % DECAY_HISTORY] = load_avg;
+  decay_coef[decay_epoch % DECAY_HISTORY]
+    = ((int64_t) (2 * load_avg)) * POINT / (2 * load_avg + POINT);
+
+  if (running != cpu_current ()->idle_thread)
+    {
+      update_recent_cpu (running, NULL);
+      update_priority (running, NULL);
+    }
+
+  /* Pull every ready thread off this CPU's run queues, then put
+     each back at its new priority, keeping their relative
+     order. */
+  list_init (&ready);
+  for (p = PRI_MAX; p >= PRI_MIN; p--)
+    list_splice (list_end (&ready), list_begin (&rq->queues[p]),
+                 list_end (&rq->queues[p]));
+  memset (rq->bitmap, 0, sizeof rq->bitmap);
+  rq->cnt = list_size (&rq->edf);
+  while (!list_empty (&ready))
+    {
+      struct thread *t = list_entry (list_pop_front (&ready),
+                                     struct thread, elem);
+      update_recent_cpu (t, NULL);
+      t->priority = mlfqs_priority (t);
+      ready_push (t);
+    }
+}
+
+/* Returns fixed-point X raised to the nonnegative power N. */
+static REAL
+fixed_pow (REAL x, int64_t n)
+{
+  REAL result = POINT;
+
+  for (; n > 0; n >>= 1)
+    {
+      if (n & 1)
+        result = ((int64_t) result) * x / POINT;
+      x = ((int64_t) x) * x / POINT;
+    }
+  return result;
+}
+
+/* Applies to T's recent_cpu the once-per-second decays that it
+   missed while it was blocked.  The last DECAY_HISTORY of them
+   are replayed exactly.  Any older ones are applied in closed
+   form, assuming the oldest remembered load_avg held throughout:
+   N decays by coefficient C turn R into
+
+     C^N * R + nice * (1 - C^N) / (1 - C)
+
+   and 1 / (1 - C) = 2*load_avg + 1. */
+static void
+mlfqs_catch_up (struct thread *t)
+{
+  int64_t missed = decay_epoch - t->decay_epoch;
+  int64_t e;
+
+  if (missed > DECAY_HISTORY)
+    {
+      int oldest = (decay_epoch - DECAY_HISTORY + 1) % DECAY_HISTORY;
+      REAL cn = fixed_pow (decay_coef[oldest], missed - DECAY_HISTORY);
+
+      t->recent_cpu = ((int64_t) cn) * t->recent_cpu / POINT
+                      + ((int64_t) t->nice) * (POINT - cn)
+                        * (2 * decay_load[oldest] + POINT) / POINT;
+      missed = DECAY_HISTORY;
+    }
+
+  for (e = decay_epoch - missed + 1; e <= decay_epoch; e++)
+    t->recent_cpu = ((int64_t) decay_coef[e % DECAY_HISTORY])
+                    * t->recent_cpu / POINT + t->nice * POINT;
+  t->decay_epoch = decay_epoch;
 }
 
 /* Offset of `stack' member within `struct thread'.
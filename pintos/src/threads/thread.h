@@ -3,7 +3,9 @@
 
 #include <debug.h>
 #include <list.h>
+#include <schedstat.h>
 #include <stdint.h>
+#include "devices/timer.h"
 #include "threads/synch.h"
 
 // #ifndef USERPROG
@@ -25,16 +27,16 @@ enum thread_status
     THREAD_DYING        /* About to be destroyed. */
   };
 
-/* Added for accessing file by fd */
-struct file_list
-{
-  int fd;
-  struct file *file;
-  struct list_elem ptr;
-};
-
-/* Lock used for file system - added */
-struct lock filesys_lock;
+/* A process's open files, indexed by file descriptor.  FILES
+   grows a page at a time; bit FD of USED is set if descriptor FD
+   is taken, so the lowest free one is found by a bit scan.
+   Descriptors 0 and 1 are the console and are never handed out. */
+struct fd_table
+  {
+    struct file **files;                /* Open file for each fd, or null. */
+    uint32_t *used;                     /* Bitmap of descriptors in use. */
+    int cap;                            /* Size of FILES, 0 before any open. */
+  };
 
 /* Thread identifier type.
    You can redefine this to whatever type you like. */
@@ -46,8 +48,9 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
-/* maximum of number of file descriptor */
-#define MAX_FD 128
+/* Thread nice values. */
+#define NICE_MIN (-20)                  /* Most favored. */
+#define NICE_MAX 20                     /* Least favored. */
 
 /* A kernel thread or user process.
 
@@ -112,12 +115,35 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Effective priority. */
+    int base_priority;                  /* Priority before donations. */
+    struct list locks;                  /* Locks held, for donation. */
+    struct lock *waiting_lock;          /* Lock being waited on, or NULL. */
     struct list_elem allelem;           /* List element for all threads list. */
     int32_t nice;                       /* Niceness */
     REAL recent_cpu;                    /* Recent_cpu */
-    int64_t ticks;
-    
+    int64_t decay_epoch;                /* MLFQS decays applied to recent_cpu. */
+    int64_t ready_tick;                 /* When it last became ready, for aging. */
+    struct alarm sleep_alarm;           /* Wakes the thread from thread_sleep(). */
+    struct cpu *cpu;                    /* CPU whose run queue it uses. */
+    int tickets;                        /* Stride scheduling tickets. */
+    int64_t pass;                       /* Stride scheduling pass. */
+    size_t heap_idx;                    /* Index in stride run queue. */
+
+    /* Earliest-deadline-first class, if edf_period > 0. */
+    int64_t edf_period;                 /* Ticks between releases. */
+    int64_t edf_budget;                 /* Ticks of CPU per period. */
+    int64_t edf_deadline;               /* End of the current period. */
+    int64_t edf_used;                   /* Ticks used this period. */
+    int edf_util;                       /* Utilization reserved. */
+    int edf_misses;                     /* Deadlines missed. */
+    bool edf_done;                      /* Finished this period's job? */
+    bool edf_throttled;                 /* Out of budget? */
+    bool edf_parked;                    /* Blocked until next release? */
+    struct alarm edf_alarm;             /* Goes off at each release. */
+    uint64_t sched_stamp;               /* TSC at last switch or wakeup. */
+    bool sched_woken;                   /* Unblocked since it last ran? */
+    struct schedstat schedstat;         /* Latency histograms. */
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
@@ -139,7 +165,8 @@ struct thread
     struct list_elem child_elem;
 
     /* Project 2-2 file system */
-    struct list filelist;
+    struct fd_table fds;
+    struct ioring *ioring;              /* User's I/O rings, or null. */
     struct file* cur_file;
 
     /* Owned by thread.c. */
@@ -151,12 +178,30 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use stride scheduling: each thread gets a share of
+   the CPU proportional to its tickets.  Controlled by kernel
+   command-line option "-stride". */
+extern bool thread_stride;
+
+/* Stride scheduling tickets. */
+#define TICKETS_MIN 1                   /* Fewest tickets. */
+#define TICKETS_DEFAULT 100             /* Default tickets. */
+#define TICKETS_MAX 10000               /* Most tickets. */
+
+/* Maximum number of pages of exited threads kept for reuse by
+   thread_create().  Controlled by kernel command-line option
+   "-tcache=N"; 0 turns the cache off. */
+#define THREAD_CACHE_DEFAULT 16
+extern size_t thread_cache_size;
+
 
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
+void thread_tick_idle (void);
 void thread_print_stats (void);
+void thread_print_schedstat (void);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -171,6 +216,10 @@ const char *thread_name (void);
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
 
+void thread_preempt_disable (void);
+void thread_preempt_enable (void);
+bool thread_preempt_check (void);
+
 /* Performs some operation on thread t, given auxiliary data AUX. */
 typedef void thread_action_func (struct thread *t, void *aux);
 void thread_foreach (thread_action_func *, void *);
@@ -179,19 +228,34 @@ void thread_sleep(int64_t);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+void thread_set_priority_of (struct thread *, int);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
+void thread_set_nice_of (struct thread *, int);
 int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
 
+int thread_get_tickets (void);
+void thread_set_tickets (int);
+int thread_stride_tickets (struct thread *);
+
+bool thread_set_deadline (int64_t period, int64_t budget);
+void thread_edf_next_period (void);
+int thread_edf_misses (void);
+bool thread_preempts (const struct thread *);
+
 int thread_add_file (struct file *file);
+struct file *thread_get_file (int fd);
+struct file *thread_remove_file (int fd);
+void thread_free_files (struct thread *);
 
-bool block_less (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 bool ready_less (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
+bool thread_priority_less (const struct list_elem *a,
+                           const struct list_elem *b, void *aux UNUSED);
+void thread_refresh_priority (struct thread *);
 
 void update_priority(struct thread *t, void *aux UNUSED);
 void update_recent_cpu(struct thread *t, void *aux UNUSED);
 void update_load_avg(void);
-void sort_ready_list(void);
 #endif /* threads/thread.h */
@@ -0,0 +1,214 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/spinlock.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#ifdef FILESYS
+#include "devices/block.h"
+#endif
+
+/* Scheduler event trace.
+
+   With the "-trace" option, the scheduler records each context
+   switch, wakeup, block, and time slice expiry in a ring buffer,
+   stamped with the time stamp counter.  The ring holds the most
+   recent TRACE_EVENTS events; older ones are overwritten.  At
+   shutdown the ring is written out, oldest event first, to the
+   console or to the scratch disk.
+
+   Recording takes no lock: each event claims its slot with an
+   atomic increment of trace_head, so it is safe from interrupt
+   handlers and, later, from several CPUs at once. */
+
+#define TRACE_PAGES 8
+#define TRACE_EVENTS (TRACE_PAGES * PGSIZE / sizeof (struct trace_event))
+
+/* Where trace_dump() writes the ring. */
+enum trace_mode
+  {
+    TRACE_OFF,                  /* Not tracing. */
+    TRACE_CONSOLE,              /* Print to the console. */
+    TRACE_SCRATCH               /* Write to the scratch disk. */
+  };
+static enum trace_mode trace_mode = TRACE_OFF;
+
+static struct trace_event *trace_ring;  /* TRACE_EVENTS events. */
+static volatile int trace_head;         /* # of events recorded. */
+
+static void trace_dump_console (const struct trace_event *,
+                                unsigned first, unsigned cnt);
+#ifdef FILESYS
+static bool trace_dump_scratch (const struct trace_event *,
+                                unsigned first, unsigned cnt);
+#endif
+
+/* Sets the trace mode from the "-trace" option's value MODE,
+   which is "console" or "scratch".  Returns false if MODE is not
+   recognized. */
+bool
+trace_configure (const char *mode) 
+{
+  if (!strcmp (mode, "console"))
+    trace_mode = TRACE_CONSOLE;
+  else if (!strcmp (mode, "scratch"))
+    trace_mode = TRACE_SCRATCH;
+  else
+    return false;
+  return true;
+}
+
+/* Allocates the trace ring, if tracing was requested.  Must be
+   called after palloc_init().  Events that happen earlier are
+   not recorded. */
+void
+trace_init (void) 
+{
+  ASSERT ((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0);
+
+  if (trace_mode != TRACE_OFF)
+    trace_ring = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, TRACE_PAGES);
+}
+
+/* Records an event of the given TYPE, concerning threads A and
+   B, with REASON and WHERE as described in struct trace_event.
+   Does nothing unless tracing is on. */
+void
+trace_record (enum trace_type type, int a, int b, int reason,
+              const void *where) 
+{
+  struct trace_event *e;
+
+  if (trace_ring == NULL)
+    return;
+
+  e = &trace_ring[(unsigned) atomic_fetch_add (&trace_head, 1)
+                  % TRACE_EVENTS];
+  e->tsc = rdtsc ();
+  e->tick = timer_ticks ();
+  e->type = type;
+  e->reason = reason;
+  e->cpu = cpu_current ()->id;
+  e->a = a;
+  e->b = b;
+  e->where = where;
+}
+
+/* Writes out the trace ring, oldest event first, to wherever
+   the "-trace" option said.  Called at shutdown.  Writing to the
+   scratch disk needs interrupts, so when they are off (as after
+   a kernel panic) the trace goes to the console instead. */
+void
+trace_dump (void) 
+{
+  struct trace_event *ring = trace_ring;
+  unsigned head, first;
+
+  if (ring == NULL)
+    return;
+
+  /* Stop recording, so that the events we print are not
+     overwritten under us. */
+  trace_ring = NULL;
+  memory_barrier ();
+  head = trace_head;
+  first = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+
+#ifdef FILESYS
+  if (trace_mode == TRACE_SCRATCH && intr_get_level () == INTR_ON
+      && trace_dump_scratch (ring, first, head - first))
+    return;
+#endif
+  trace_dump_console (ring, first, head - first);
+}
+
+/* Prints CNT events from RING, starting with event number FIRST,
+   one per line.  Times are in cycles since the first event. */
+static void
+trace_dump_console (const struct trace_event *ring,
+                    unsigned first, unsigned cnt) 
+{
+  static const char *types[] = {"switch", "wakeup", "block", "preempt"};
+  static const char *reasons[] = {"running", "yield", "block", "exit"};
+  uint64_t start;
+  unsigned i;
+
+  printf ("Trace: %u events, oldest first\n", cnt);
+  if (cnt == 0)
+    return;
+  start = ring[first % TRACE_EVENTS].tsc;
+  for (i = first; i != first + cnt; i++) 
+    {
+      const struct trace_event *e = &ring[i % TRACE_EVENTS];
+
+      printf ("%12"PRIu64" %6"PRId64" cpu%u %-7s %d",
+              e->tsc - start, e->tick, (unsigned) e->cpu,
+              types[e->type], e->a);
+      switch (e->type) 
+        {
+        case TRACE_SWITCH:
+          printf (" -> %d (%s)", e->b, reasons[e->reason]);
+          break;
+        case TRACE_WAKEUP:
+          printf (" by %d", e->b);
+          break;
+        case TRACE_BLOCK:
+          printf (" at %p", e->where);
+          break;
+        }
+      putchar ('\n');
+    }
+}
+
+#ifdef FILESYS
+/* Writes CNT events from RING, starting with event number FIRST,
+   to the scratch disk.  Sector 0 holds a header: the string
+   "TRACE", the event count, and the event size, as 32-bit
+   little-endian words after the string.  The events follow,
+   16 to a sector, oldest first.  Returns false if there is no
+   scratch disk. */
+static bool
+trace_dump_scratch (const struct trace_event *ring,
+                    unsigned first, unsigned cnt) 
+{
+  enum { PER_SECTOR = BLOCK_SECTOR_SIZE / sizeof (struct trace_event) };
+  static struct trace_event buf[PER_SECTOR];
+  struct block *scratch = block_get_role (BLOCK_SCRATCH);
+  uint32_t *header = (uint32_t *) buf;
+  block_sector_t sector;
+  unsigned i;
+
+  ASSERT (BLOCK_SECTOR_SIZE % sizeof (struct trace_event) == 0);
+
+  if (scratch == NULL)
+    return false;
+  if (cnt > (block_size (scratch) - 1) * PER_SECTOR)
+    cnt = (block_size (scratch) - 1) * PER_SECTOR;
+
+  memset (buf, 0, sizeof buf);
+  memcpy (header, "TRACE\0\0\0", 8);
+  header[2] = cnt;
+  header[3] = sizeof (struct trace_event);
+  block_write (scratch, 0, buf);
+
+  sector = 1;
+  for (i = 0; i < cnt; i++) 
+    {
+      buf[i % PER_SECTOR] = ring[(first + i) % TRACE_EVENTS];
+      if (i % PER_SECTOR == PER_SECTOR - 1 || i == cnt - 1)
+        {
+          block_write (scratch, sector++, buf);
+          memset (buf, 0, sizeof buf);
+        }
+    }
+
+  printf ("Trace: %u events written to %s\n", cnt, block_name (scratch));
+  return true;
+}
+#endif
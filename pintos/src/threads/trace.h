@@ -0,0 +1,35 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Kinds of scheduler event. */
+enum trace_type
+  {
+    TRACE_SWITCH,               /* schedule() ran B in place of A. */
+    TRACE_WAKEUP,               /* Thread A was unblocked by B. */
+    TRACE_BLOCK,                /* Thread A blocked on a semaphore. */
+    TRACE_PREEMPT               /* Thread A's time slice ran out. */
+  };
+
+/* One scheduler event.  32 bytes, so that a disk sector holds
+   exactly 16 of them. */
+struct trace_event
+  {
+    uint64_t tsc;               /* Time stamp counter. */
+    int64_t tick;               /* Timer ticks since boot. */
+    uint8_t type;               /* A TRACE_* value. */
+    uint8_t reason;             /* TRACE_SWITCH: status A left with. */
+    uint16_t cpu;               /* Processor the event happened on. */
+    int32_t a, b;               /* Thread ids, or 0 for none. */
+    const void *where;          /* TRACE_BLOCK: caller of sema_down(). */
+  };
+
+bool trace_configure (const char *mode);
+void trace_init (void);
+void trace_record (enum trace_type, int a, int b, int reason,
+                   const void *where);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
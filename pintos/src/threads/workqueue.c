@@ -0,0 +1,234 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/spinlock.h"
+#include "threads/thread.h"
+
+/* Deferred work.
+
+   Interrupt handlers must not sleep and should run with
+   interrupts off for as short a time as possible.  A handler can
+   instead acknowledge its device, package the rest of its work
+   as a `struct work', and queue it with work_queue(), which is
+   safe to call from interrupt context.  A worker kernel thread
+   then runs the item with interrupts on.
+
+   Each queue keeps its items on a lock-free stack: work_queue()
+   pushes with a compare-and-exchange, and the worker takes the
+   whole stack at once with an exchange, so neither side ever
+   waits for the other.  Only a push onto an empty stack wakes
+   the worker, which then runs everything it took, oldest
+   first. */
+
+struct workqueue wq_high;
+struct workqueue wq_normal;
+struct workqueue wq_low;
+
+static void workqueue_setup (struct workqueue *, const char *name,
+                             int priority);
+static void workqueue_spawn (struct workqueue *);
+static thread_func worker;
+static void work_push (struct workqueue *, struct work *);
+static alarm_func work_timer;
+
+/* Sets up the system workqueues, so that work can be queued to
+   them.  Their workers do not run until workqueue_start(), so
+   this may be called before interrupts are enabled. */
+void
+workqueue_init (void) 
+{
+  workqueue_setup (&wq_high, "wq-high", PRI_MAX);
+  workqueue_setup (&wq_normal, "wq-normal", PRI_DEFAULT);
+  workqueue_setup (&wq_low, "wq-low", PRI_MIN + 1);
+}
+
+/* Creates the worker threads for the system workqueues.  Must be
+   called after thread_start().  Work queued earlier runs now. */
+void
+workqueue_start (void) 
+{
+  workqueue_spawn (&wq_high);
+  workqueue_spawn (&wq_normal);
+  workqueue_spawn (&wq_low);
+}
+
+/* Initializes WQ as a workqueue named NAME and starts its worker
+   thread at PRIORITY. */
+void
+workqueue_create (struct workqueue *wq, const char *name, int priority) 
+{
+  workqueue_setup (wq, name, priority);
+  workqueue_spawn (wq);
+}
+
+/* Prints workqueue statistics. */
+void
+workqueue_print_stats (void) 
+{
+  printf ("Workqueue: %"PRId64" high, %"PRId64" normal, "
+          "%"PRId64" low items run\n",
+          wq_high.run_cnt, wq_normal.run_cnt, wq_low.run_cnt);
+}
+
+/* Initializes W to call FUNC(W) when it runs.  AUX is stored in
+   W for FUNC's use. */
+void
+work_init (struct work *w, work_func *func, void *aux) 
+{
+  ASSERT (w != NULL);
+  ASSERT (func != NULL);
+
+  w->next = NULL;
+  w->func = func;
+  w->aux = aux;
+  w->pending = 0;
+  w->wq = NULL;
+  alarm_init (&w->alarm, work_timer, w);
+}
+
+/* Queues W to run on WQ's worker.  Returns true if W was queued,
+   false if it was already pending, in which case it will run
+   just once.  Once W starts running it is no longer pending, so
+   it may queue itself again.
+
+   Never sleeps or spins, so it may be called from an interrupt
+   handler. */
+bool
+work_queue (struct workqueue *wq, struct work *w) 
+{
+  ASSERT (wq != NULL);
+  ASSERT (w != NULL);
+
+  if (atomic_xchg (&w->pending, 1))
+    return false;
+  work_push (wq, w);
+  return true;
+}
+
+/* Queues W to run on WQ's worker after TICKS timer ticks.
+   Returns false if W was already pending.  May be called from
+   an interrupt handler. */
+bool
+work_queue_delayed (struct workqueue *wq, struct work *w, int64_t ticks) 
+{
+  ASSERT (wq != NULL);
+  ASSERT (w != NULL);
+
+  if (ticks <= 0)
+    return work_queue (wq, w);
+  if (atomic_xchg (&w->pending, 1))
+    return false;
+  w->wq = wq;
+  alarm_set (&w->alarm, timer_ticks () + ticks, 0);
+  return true;
+}
+
+/* Cancels W if it was queued with work_queue_delayed() and its
+   delay has not yet run out.  Returns true if W was cancelled,
+   false if it was not waiting on its delay.  An item that has
+   already reached its queue cannot be cancelled. */
+bool
+work_cancel_delayed (struct work *w) 
+{
+  enum intr_level old_level;
+  bool cancelled;
+
+  ASSERT (w != NULL);
+
+  old_level = intr_disable ();
+  cancelled = alarm_pending (&w->alarm);
+  if (cancelled)
+    {
+      alarm_cancel (&w->alarm);
+      w->pending = 0;
+    }
+  intr_set_level (old_level);
+  return cancelled;
+}
+
+/* Initializes WQ as an empty queue without a worker. */
+static void
+workqueue_setup (struct workqueue *wq, const char *name, int priority) 
+{
+  ASSERT (wq != NULL);
+  ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+  wq->name = name;
+  wq->priority = priority;
+  wq->head = NULL;
+  sema_init (&wq->ready, 0);
+  wq->run_cnt = 0;
+}
+
+/* Starts WQ's worker thread. */
+static void
+workqueue_spawn (struct workqueue *wq) 
+{
+  if (thread_create (wq->name, wq->priority, worker, wq) == TID_ERROR)
+    PANIC ("%s: cannot create worker thread", wq->name);
+}
+
+/* Pushes W, which must already be marked pending, onto WQ's
+   stack, and wakes WQ's worker if the stack was empty. */
+static void
+work_push (struct workqueue *wq, struct work *w) 
+{
+  struct work *head;
+
+  do 
+    {
+      head = wq->head;
+      w->next = head;
+    }
+  while (atomic_cmpxchg_ptr ((void *volatile *) &wq->head, head, w) != head);
+
+  if (head == NULL)
+    sema_up (&wq->ready);
+}
+
+/* Alarm function for delayed work item W_: its delay ran out, so
+   queue it.  Runs in the timer interrupt. */
+static void
+work_timer (void *w_) 
+{
+  struct work *w = w_;
+
+  work_push (w->wq, w);
+}
+
+/* Worker thread for workqueue WQ_.  Each time it is woken, takes
+   every queued item and runs them in the order they were
+   queued. */
+static void
+worker (void *wq_) 
+{
+  struct workqueue *wq = wq_;
+
+  for (;;) 
+    {
+      struct work *stack, *fifo = NULL;
+
+      sema_down (&wq->ready);
+      stack = atomic_xchg_ptr ((void *volatile *) &wq->head, NULL);
+
+      /* The stack is newest first; reverse it. */
+      while (stack != NULL) 
+        {
+          struct work *next = stack->next;
+          stack->next = fifo;
+          fifo = stack;
+          stack = next;
+        }
+
+      while (fifo != NULL) 
+        {
+          struct work *w = fifo;
+          fifo = w->next;
+          atomic_xchg (&w->pending, 0);
+          w->func (w);
+          wq->run_cnt++;
+        }
+    }
+}
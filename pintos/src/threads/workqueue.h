@@ -0,0 +1,54 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+#include "threads/synch.h"
+
+struct work;
+struct workqueue;
+
+/* Function that carries out a work item.  Runs in a worker
+   thread, so it may sleep. */
+typedef void work_func (struct work *);
+
+/* A work item: a function call deferred to a worker thread.
+   Usually embedded in a larger structure that FUNC recovers
+   with list_entry()-style arithmetic, or reached through AUX. */
+struct work
+  {
+    struct work *next;          /* Next item in a queue's stack. */
+    work_func *func;            /* Function to call. */
+    void *aux;                  /* Auxiliary data for FUNC. */
+    volatile int pending;       /* 1 while queued or delayed. */
+    struct workqueue *wq;       /* Queue a delayed item goes to. */
+    struct alarm alarm;         /* Timer for delayed work. */
+  };
+
+/* A queue of work items and the kernel thread that runs them. */
+struct workqueue
+  {
+    const char *name;           /* Name of the worker thread. */
+    int priority;               /* Priority of the worker thread. */
+    struct work *volatile head; /* Queued items, newest first. */
+    struct semaphore ready;     /* Upped when HEAD becomes nonempty. */
+    int64_t run_cnt;            /* # of items run. */
+  };
+
+/* System workqueues, one per worker priority. */
+extern struct workqueue wq_high;        /* Worker at PRI_MAX. */
+extern struct workqueue wq_normal;      /* Worker at PRI_DEFAULT. */
+extern struct workqueue wq_low;         /* Worker at PRI_MIN + 1. */
+
+void workqueue_init (void);
+void workqueue_start (void);
+void workqueue_create (struct workqueue *, const char *name, int priority);
+void workqueue_print_stats (void);
+
+void work_init (struct work *, work_func *, void *aux);
+bool work_queue (struct workqueue *, struct work *);
+bool work_queue_delayed (struct workqueue *, struct work *, int64_t ticks);
+bool work_cancel_delayed (struct work *);
+
+#endif /* threads/workqueue.h */
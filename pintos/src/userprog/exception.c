@@ -8,6 +8,7 @@
 #include "threads/vaddr.h"
 #include "userprog/syscall.h"
 #include "userprog/pagedir.h"
+#include "userprog/uaccess.h"
 
 #include "threads/palloc.h"
 #define PG_LIMIT 0xBF800000
@@ -151,6 +152,11 @@ page_fault (struct intr_frame *f)
   /* Count page faults. */
   page_fault_cnt++;
 
+  /* A fault on user memory inside copy_from_user() and friends is
+     an error for them to return, not a kernel bug. */
+  if ((f->error_code & PF_U) == 0 && uaccess_fixup (f))
+    return;
+
   syscall_exit(-1);
 
   /* Determine cause. */
@@ -166,6 +166,8 @@ process_exit (void)
   struct thread *cur = thread_current ();
   uint32_t *pd;
 
+  thread_free_files (cur);
+
   /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
   pd = cur->pagedir;
@@ -316,9 +318,9 @@ load (const char *file_name, void (**eip) (void), void **esp)
     }
 
   /* Open executable file. */
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_shared (&filesys_lock);
   file = filesys_open (argv[0]);
-  lock_release(&filesys_lock);
+  rwlock_release_shared (&filesys_lock);
   if (file == NULL) 
     {
       printf ("load: %s: open failed\n", file_name);
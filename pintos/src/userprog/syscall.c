@@ -1,23 +1,31 @@
 #include "userprog/syscall.h"
 #include "userprog/process.h"
 #include "userprog/exception.h"
+#include "userprog/tss.h"
+#include "userprog/uaccess.h"
 #include "lib/user/syscall.h"
 #include <stdio.h>
 #include <syscall-nr.h>
 #include <stdbool.h>
 #include <string.h>
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
+#include "threads/loader.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 
 #include "devices/shutdown.h"
 #include "devices/input.h"
 #include "lib/kernel/console.h"
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 
 static void syscall_handler (struct intr_frame *);
+static bool sysenter_supported (void);
+void syscall_sysenter (void);
 void syscall_halt(void);
 pid_t syscall_exec(const char *cmd_line);
 int syscall_wait(pid_t pid);
@@ -25,6 +33,16 @@ int syscall_read(int fd, void *buffer, unsigned size);
 int syscall_write(int fd, const void *buffer, unsigned size);
 int syscall_fibonacci(int n);
 int syscall_sum_of_four_integers(int a, int b, int c, int d);
+bool syscall_schedstat(struct schedstat *stats);
+bool syscall_setpriority(pid_t pid, int priority);
+int syscall_getpriority(pid_t pid);
+int syscall_nice(pid_t pid, int increment);
+int syscall_pread(int fd, void *buffer, unsigned size, unsigned offset);
+int syscall_pwrite(int fd, const void *buffer, unsigned size, unsigned offset);
+int syscall_readv(int fd, const struct iovec *iov, int iovcnt);
+int syscall_writev(int fd, const struct iovec *iov, int iovcnt);
+bool syscall_ioring_setup(struct ioring *ring);
+int syscall_ioring_enter(void);
 
 bool syscall_create(const char *file, unsigned initial_size);
 bool syscall_remove(const char *file);
@@ -34,205 +52,338 @@ void syscall_seek(int fd, unsigned position);
 off_t syscall_tell(int fd);
 void syscall_close(int fd);
 
-/* syscall handler helper */
-// check argc and argv is valid virtual address using esp
-// We only use this function in syscall.c
-static bool is_valid_arg (const void* esp, int argc);
-//static bool is_valid_arg3 (const void* esp, int argc);
+static struct thread *sched_target (pid_t pid);
+static bool sched_privileged (void);
 struct file* search_file(int fd);
 
-#ifndef __ESP_ARGV__
-
-#define __ESP_ARGV__
-#define ESP_ARGV_PTR(ESP, INDEX) ((void*)((uintptr_t)(ESP) + ((INDEX) + 1) * 4)) // 4 means sizeof(uintptr_t)
-
-#endif
+static bool copy_in_name (char name[NAME_MAX + 2], const char *uname);
+
+/* Most arguments any system call takes. */
+#define SYSCALL_MAX_ARGS 4
+
+/* Kinds of system call argument.  syscall_handler() copies a
+   file name into a kernel buffer and hands the handler the copy,
+   so that the file system never reads user memory.  Handlers
+   access pointers and buffers only through the primitives in
+   userprog/uaccess.h, which catch bad addresses themselves, so
+   those go unchecked here. */
+enum syscall_arg
+  {
+    ARG_INT,                    /* Integer. */
+    ARG_PTR,                    /* User pointer. */
+    ARG_STR,                    /* User file name. */
+    ARG_BUF                     /* User buffer, size in the next arg. */
+  };
+
+/* A system call handler, given the arguments from the user stack. */
+typedef uint32_t syscall_func (const uint32_t *args);
+
+/* Describes a system call. */
+struct syscall_desc
+  {
+    syscall_func *func;                         /* Handler. */
+    int argc;                                   /* Number of arguments. */
+    enum syscall_arg kinds[SYSCALL_MAX_ARGS];   /* Kind of each argument. */
+  };
+
+static syscall_func sys_halt, sys_exit, sys_exec, sys_wait;
+static syscall_func sys_create, sys_remove, sys_open, sys_filesize;
+static syscall_func sys_read, sys_write, sys_seek, sys_tell, sys_close;
+static syscall_func sys_fibonacci, sys_sum, sys_schedstat;
+static syscall_func sys_setpriority, sys_getpriority, sys_nice;
+static syscall_func sys_pread, sys_pwrite, sys_readv, sys_writev;
+static syscall_func sys_ioring_setup, sys_ioring_enter;
+
+/* System calls, indexed by number.  Numbers with a null FUNC,
+   such as those for projects 3 and 4, are not implemented. */
+static const struct syscall_desc syscall_table[NUM_SYSCALL] =
+  {
+    [SYS_HALT] = {sys_halt, 0, {}},
+    [SYS_EXIT] = {sys_exit, 1, {ARG_INT}},
+    [SYS_EXEC] = {sys_exec, 1, {ARG_PTR}},
+    [SYS_WAIT] = {sys_wait, 1, {ARG_INT}},
+    [SYS_CREATE] = {sys_create, 2, {ARG_STR, ARG_INT}},
+    [SYS_REMOVE] = {sys_remove, 1, {ARG_STR}},
+    [SYS_OPEN] = {sys_open, 1, {ARG_STR}},
+    [SYS_FILESIZE] = {sys_filesize, 1, {ARG_INT}},
+    [SYS_READ] = {sys_read, 3, {ARG_INT, ARG_BUF, ARG_INT}},
+    [SYS_WRITE] = {sys_write, 3, {ARG_INT, ARG_BUF, ARG_INT}},
+    [SYS_SEEK] = {sys_seek, 2, {ARG_INT, ARG_INT}},
+    [SYS_TELL] = {sys_tell, 1, {ARG_INT}},
+    [SYS_CLOSE] = {sys_close, 1, {ARG_INT}},
+    [SYS_FIBO] = {sys_fibonacci, 1, {ARG_INT}},
+    [SYS_SUM] = {sys_sum, 4, {ARG_INT, ARG_INT, ARG_INT, ARG_INT}},
+    [SYS_SCHEDSTAT] = {sys_schedstat, 1, {ARG_PTR}},
+    [SYS_SETPRIORITY] = {sys_setpriority, 2, {ARG_INT, ARG_INT}},
+    [SYS_GETPRIORITY] = {sys_getpriority, 1, {ARG_INT}},
+    [SYS_NICE] = {sys_nice, 2, {ARG_INT, ARG_INT}},
+    [SYS_PREAD] = {sys_pread, 4, {ARG_INT, ARG_BUF, ARG_INT, ARG_INT}},
+    [SYS_PWRITE] = {sys_pwrite, 4, {ARG_INT, ARG_BUF, ARG_INT, ARG_INT}},
+    [SYS_READV] = {sys_readv, 3, {ARG_INT, ARG_PTR, ARG_INT}},
+    [SYS_WRITEV] = {sys_writev, 3, {ARG_INT, ARG_PTR, ARG_INT}},
+    [SYS_IORING_SETUP] = {sys_ioring_setup, 1, {ARG_PTR}},
+    [SYS_IORING_ENTER] = {sys_ioring_enter, 0, {}},
+  };
 
 void
 syscall_init (void) 
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+
+  /* Also accept system calls through SYSENTER, which skips the
+     interrupt gate and the full register save in intr_entry. */
+  if (sysenter_supported ())
+    {
+      wrmsr (MSR_SYSENTER_CS, SEL_KCSEG);
+      wrmsr (MSR_SYSENTER_EIP, (uintptr_t) syscall_sysenter);
+      tss_enable_sysenter ();
+    }
 }
 
-static void
-syscall_handler (struct intr_frame *f /* UNUSED */) 
+/* Returns true if the CPU implements SYSENTER and SYSEXIT.  Some
+   early Pentium Pros claim to but do not.  See [IA32-v2b]
+   "SYSENTER". */
+static bool
+sysenter_supported (void) 
 {
-  int sysnum = *(int *)f->esp;
-  void *temp_esp = f->esp;
+  uint32_t regs[4];
+  unsigned family, model, stepping;
+
+  cpuid (1, regs);
+  family = (regs[0] >> 8) & 0xf;
+  model = (regs[0] >> 4) & 0xf;
+  stepping = regs[0] & 0xf;
+  return (regs[3] & (1u << 11)) != 0
+         && !(family == 6 && model < 3 && stepping < 3);
+}
 
+/* Handles a system call made through SYSENTER and returns its
+   result.  syscall_sysenter() passes only the user stack
+   pointer ESP, but that is all syscall_handler() reads from the
+   frame: the number and arguments are on the user stack just as
+   for `int $0x30'. */
+uint32_t
+syscall_fast (void *esp)
+{
+  struct intr_frame f;
 
-  // handle a variety of system calls
-  // access to system call by esp pointer in intr_frame
-  // check that syscall number is valid
-  if (-1 < sysnum && sysnum < NUM_SYSCALL)
+  f.esp = esp;
+  f.eax = 0;
+  syscall_handler (&f);
+  return f.eax;
+}
+
+/* Reads the system call number and arguments from the user stack
+   at F->esp, checks them against the number's descriptor, and
+   calls its handler.  The arguments are copied out of user
+   memory in a single copy_from_user().  A process that passes a
+   bad pointer is killed; an unknown or unimplemented system call
+   returns -1. */
+static void
+syscall_handler (struct intr_frame *f) 
+{
+  const uint32_t *frame = f->esp;
+  const struct syscall_desc *desc;
+  uint32_t args[SYSCALL_MAX_ARGS];
+  char names[SYSCALL_MAX_ARGS][NAME_MAX + 2];
+  uint32_t sysnum;
+  int i;
+
+  if (!copy_from_user (&sysnum, frame, sizeof sysnum))
+    syscall_exit (-1);
+  if (sysnum >= NUM_SYSCALL || syscall_table[sysnum].func == NULL)
     {
-      switch(sysnum)
-        {
-        case SYS_HALT:
-            {
-              syscall_halt ();
-            }
-          break;
-        case SYS_EXIT:
-            {
-              if (!is_valid_arg(temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              syscall_exit(*(int*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_EXEC:
-            {
-              if (!is_valid_arg(temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              // put command line in the system call
-              f->eax = syscall_exec(*(char**)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_WAIT:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_wait(*(pid_t*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_CREATE:
-            {
-              if (!is_valid_arg (temp_esp, 2))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_create(*(char**)ESP_ARGV_PTR(temp_esp, 0),
-                                      (unsigned)*(int *)ESP_ARGV_PTR(temp_esp,1)
-                                     );
-            }
-          break;
-        case SYS_REMOVE:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_remove(*(char**)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_OPEN:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_open(*(char**)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_FILESIZE:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_filesize(*(int*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_READ:
-            {
-              if (!is_valid_arg (temp_esp, 3))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_read(*(int*)ESP_ARGV_PTR(temp_esp, 0),
-                                    (void*)*(int*)ESP_ARGV_PTR(temp_esp, 1),
-                                    (size_t)*(int*)ESP_ARGV_PTR(temp_esp, 2)
-                                   );
-            }
-          break;
-        case SYS_WRITE:
-            {
-              if (!is_valid_arg(temp_esp, 3))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_write (*(int*)ESP_ARGV_PTR(temp_esp, 0),
-                                      (void*)*(int*)ESP_ARGV_PTR(temp_esp, 1),
-                                      (size_t)*(int*)ESP_ARGV_PTR(temp_esp, 2)
-                                     );
-
-            }
-          break;
-        case SYS_SEEK:
-            {
-              if (!is_valid_arg (temp_esp, 2))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              syscall_seek(*(int*)ESP_ARGV_PTR(temp_esp, 0),
-                           (unsigned)*(int*)ESP_ARGV_PTR(temp_esp, 1)
-                          );
-            }
-          break;
-        case SYS_TELL:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_tell(*(int*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_CLOSE:
-            {
-              if (!is_valid_arg (temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              syscall_close(*(int*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_FIBO: // Calculate fibonacci
-            {
-              if (!is_valid_arg(temp_esp, 1))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_fibonacci (*(int*)ESP_ARGV_PTR(temp_esp, 0));
-            }
-          break;
-        case SYS_SUM: // Sum Of four integers
-            {
-              if (!is_valid_arg(temp_esp, 4))
-                {
-                  syscall_exit(-1);
-                  break;
-                }
-              f->eax = syscall_sum_of_four_integers(*(int*)ESP_ARGV_PTR(temp_esp, 0),
-                                                    *(int*)ESP_ARGV_PTR(temp_esp, 1),
-                                                    *(int*)ESP_ARGV_PTR(temp_esp, 2),
-                                                    *(int*)ESP_ARGV_PTR(temp_esp, 3)
-                                                   );
-            }
-          break;
-        }
+      f->eax = -1;
+      return;
     }
+  desc = &syscall_table[sysnum];
+
+  if (!copy_from_user (args, frame + 1, desc->argc * sizeof *args))
+    syscall_exit (-1);
+  for (i = 0; i < desc->argc; i++)
+    if (desc->kinds[i] == ARG_STR)
+      {
+        if (!copy_in_name (names[i], (const char *) args[i]))
+          syscall_exit (-1);
+        args[i] = (uint32_t) names[i];
+      }
+
+  f->eax = desc->func (args);
 }
 
+/* Copies the file name at user address UNAME into NAME.  A name
+   longer than NAME_MAX is cut to NAME_MAX + 1 characters, which
+   the file system rejects just as it would the whole name.
+   Returns false if UNAME is bad. */
+static bool
+copy_in_name (char name[NAME_MAX + 2], const char *uname)
+{
+  if (strncpy_from_user (name, uname, NAME_MAX + 2) < 0)
+    return false;
+  name[NAME_MAX + 1] = '\0';
+  return true;
+}
+
+/* Handlers for the system call table, which unpack the
+   arguments that syscall_handler() has already checked or
+   copied. */
+static uint32_t
+sys_halt (const uint32_t *args UNUSED)
+{
+  syscall_halt ();
+  NOT_REACHED ();
+}
+
+static uint32_t
+sys_exit (const uint32_t *args)
+{
+  syscall_exit ((int) args[0]);
+  NOT_REACHED ();
+}
+
+static uint32_t
+sys_exec (const uint32_t *args)
+{
+  return syscall_exec ((const char *) args[0]);
+}
+
+static uint32_t
+sys_wait (const uint32_t *args)
+{
+  return syscall_wait ((pid_t) args[0]);
+}
+
+static uint32_t
+sys_create (const uint32_t *args)
+{
+  return syscall_create ((const char *) args[0], args[1]);
+}
+
+static uint32_t
+sys_remove (const uint32_t *args)
+{
+  return syscall_remove ((const char *) args[0]);
+}
+
+static uint32_t
+sys_open (const uint32_t *args)
+{
+  return syscall_open ((const char *) args[0]);
+}
+
+static uint32_t
+sys_filesize (const uint32_t *args)
+{
+  return syscall_filesize ((int) args[0]);
+}
+
+static uint32_t
+sys_read (const uint32_t *args)
+{
+  return syscall_read ((int) args[0], (void *) args[1], args[2]);
+}
+
+static uint32_t
+sys_write (const uint32_t *args)
+{
+  return syscall_write ((int) args[0], (const void *) args[1], args[2]);
+}
+
+static uint32_t
+sys_seek (const uint32_t *args)
+{
+  syscall_seek ((int) args[0], args[1]);
+  return 0;
+}
+
+static uint32_t
+sys_tell (const uint32_t *args)
+{
+  return syscall_tell ((int) args[0]);
+}
+
+static uint32_t
+sys_close (const uint32_t *args)
+{
+  syscall_close ((int) args[0]);
+  return 0;
+}
+
+static uint32_t
+sys_fibonacci (const uint32_t *args)
+{
+  return syscall_fibonacci ((int) args[0]);
+}
+
+static uint32_t
+sys_sum (const uint32_t *args)
+{
+  return syscall_sum_of_four_integers ((int) args[0], (int) args[1],
+                                       (int) args[2], (int) args[3]);
+}
+
+static uint32_t
+sys_schedstat (const uint32_t *args)
+{
+  return syscall_schedstat ((struct schedstat *) args[0]);
+}
+
+static uint32_t
+sys_setpriority (const uint32_t *args)
+{
+  return syscall_setpriority ((pid_t) args[0], (int) args[1]);
+}
+
+static uint32_t
+sys_getpriority (const uint32_t *args)
+{
+  return syscall_getpriority ((pid_t) args[0]);
+}
+
+static uint32_t
+sys_nice (const uint32_t *args)
+{
+  return syscall_nice ((pid_t) args[0], (int) args[1]);
+}
+
+static uint32_t
+sys_pread (const uint32_t *args)
+{
+  return syscall_pread ((int) args[0], (void *) args[1], args[2], args[3]);
+}
+
+static uint32_t
+sys_pwrite (const uint32_t *args)
+{
+  return syscall_pwrite ((int) args[0], (const void *) args[1], args[2],
+                         args[3]);
+}
+
+static uint32_t
+sys_readv (const uint32_t *args)
+{
+  return syscall_readv ((int) args[0], (const struct iovec *) args[1],
+                        (int) args[2]);
+}
+
+static uint32_t
+sys_writev (const uint32_t *args)
+{
+  return syscall_writev ((int) args[0], (const struct iovec *) args[1],
+                         (int) args[2]);
+}
+
+static uint32_t
+sys_ioring_setup (const uint32_t *args)
+{
+  return syscall_ioring_setup ((struct ioring *) args[0]);
+}
+
+static uint32_t
+sys_ioring_enter (const uint32_t *args UNUSED)
+{
+  return syscall_ioring_enter ();
+}
 
 void
 syscall_halt(void)
@@ -245,23 +396,20 @@ void
 syscall_exit(int status)
 {
   struct thread *cur = thread_current();
-  struct file_list *fl_temp;
+  struct file *file;
+  int fd;
 
   cur->parent->exit_status = status;
   printf("%s: exit(%d)\n", cur->name, status);
 
   /* remove all files of the current thread */
   struct list_elem *e;
-  while (!list_empty(&cur->filelist))
-    {
-      struct list_elem *e = list_pop_front(&cur->filelist);
-      fl_temp = list_entry(e, struct file_list, ptr);
-      file_close(fl_temp->file);
-      free(fl_temp);
-    }
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_exclusive (&filesys_lock);
+  for (fd = 0; fd < cur->fds.cap; fd++)
+    if ((file = thread_remove_file(fd)) != NULL)
+      file_close(file);
   file_close(cur->cur_file);
-  lock_release(&filesys_lock);
+  rwlock_release_exclusive (&filesys_lock);
 
 
   struct thread *parent = cur->parent;
@@ -285,10 +433,21 @@ syscall_exit(int status)
 pid_t
 syscall_exec(const char *cmd_line)
 {
-  if (!is_valid_ptr(cmd_line))
-    syscall_exit(-1);
+  char *copy = palloc_get_page(0);
+  pid_t pid;
 
-  return (pid_t)process_execute(cmd_line);
+  if (copy == NULL)
+    return PID_ERROR;
+  if (strncpy_from_user(copy, cmd_line, PGSIZE) < 0)
+    {
+      palloc_free_page(copy);
+      syscall_exit(-1);
+    }
+  copy[PGSIZE - 1] = '\0';
+
+  pid = (pid_t)process_execute(copy);
+  palloc_free_page(copy);
+  return pid;
 }
 
 int
@@ -297,60 +456,334 @@ syscall_wait(pid_t pid)
   return process_wait((tid_t)pid);
 }
 
+/* Moves up to SIZE bytes between FILE, at offset OFS, and user
+   memory at UBUF, staging them in the kernel page BOUNCE so that
+   only the uaccess primitives touch UBUF.  Reads from FILE into
+   UBUF if WRITE is false, writes UBUF to FILE if it is true.  The
+   caller must hold filesys_lock.  Returns the number of bytes
+   moved, which is short at end of file, or -1 if UBUF is bad. */
+static int
+file_xfer (struct file *file, uint8_t *ubuf, unsigned size, off_t ofs,
+           bool write, uint8_t *bounce)
+{
+  unsigned done = 0;
+
+  while (done < size)
+    {
+      unsigned chunk = size - done < PGSIZE ? size - done : PGSIZE;
+      int result;
+
+      if (write)
+        {
+          if (!copy_from_user (bounce, ubuf + done, chunk))
+            return -1;
+          result = file_write_at (file, bounce, chunk, ofs + done);
+        }
+      else
+        {
+          result = file_read_at (file, bounce, chunk, ofs + done);
+          if (result > 0 && !copy_to_user (ubuf + done, bounce, result))
+            return -1;
+        }
+      done += result;
+      if ((unsigned) result < chunk)
+        break;
+    }
+  return done;
+}
+
+/* Reads or writes, as WRITE says, SIZE bytes of FD's file at
+   offset OFS, or at its current position if OFS is -1, which is
+   then advanced.  Takes filesys_lock once for the whole transfer.
+   Returns the number of bytes moved, or -1 if FD is not open.
+   Kills the process if BUFFER is bad. */
+static int
+file_xfer_fd (int fd, void *buffer, unsigned size, off_t ofs, bool write)
+{
+  struct file *file = search_file(fd);
+  uint8_t *bounce;
+  bool seek = ofs < 0;
+  int result;
+
+  if (file == NULL)
+    return -1;
+  bounce = palloc_get_page(0);
+  if (bounce == NULL)
+    return -1;
+
+  if (write)
+    rwlock_acquire_exclusive (&filesys_lock);
+  else
+    rwlock_acquire_shared (&filesys_lock);
+  if (seek)
+    ofs = file_tell(file);
+  result = file_xfer(file, buffer, size, ofs, write, bounce);
+  if (seek && result > 0)
+    file_seek(file, ofs + result);
+  if (write)
+    rwlock_release_exclusive (&filesys_lock);
+  else
+    rwlock_release_shared (&filesys_lock);
+
+  palloc_free_page(bounce);
+  if (result < 0)
+    syscall_exit(-1);
+  return result;
+}
+
+/* Reads up to SIZE bytes from FD into user BUFFER. */
 int
 syscall_read(int fd, void *buffer, unsigned size)
 {
-  if (!is_valid_ptr(buffer))
-    syscall_exit(-1);
+  uint8_t *udst = buffer;
+  unsigned done = 0;
 
-  unsigned i=0;
   if(fd == 0)
     {
-      do{
-        *((uint8_t *)buffer + i) = input_getc();
-        i++;
-      }while(i<size && (*((uint8_t *)buffer + i) != '\n'));
-      return i;
+      while (done < size)
+        {
+          uint8_t c = input_getc();
+          if (!copy_to_user(udst + done++, &c, 1))
+            syscall_exit(-1);
+          if (c == '\n')
+            break;
+        }
+      return done;
     }
-  else
+  return file_xfer_fd(fd, buffer, size, -1, false);
+}
+
+/* Writes SIZE bytes of user BUFFER to the console, which takes
+   them a page at a time through a kernel copy.  Returns SIZE, or
+   -1 if memory is short.  Kills the process if BUFFER is bad. */
+static int
+console_write_user(const void *buffer, unsigned size)
+{
+  const uint8_t *usrc = buffer;
+  uint8_t *bounce = palloc_get_page(0);
+  unsigned done;
+
+  if (bounce == NULL)
+    return -1;
+  for (done = 0; done < size; )
     {
-      struct file* file = search_file(fd);
-      if(file == NULL) return -1;
+      unsigned chunk = size - done < PGSIZE ? size - done : PGSIZE;
 
-      int result;
-      lock_acquire(&filesys_lock);
-      result = (int)file_read(file,buffer,(off_t)size);
-      lock_release(&filesys_lock);
-      return result;
+      if (!copy_from_user(bounce, usrc + done, chunk))
+        {
+          palloc_free_page(bounce);
+          syscall_exit(-1);
+        }
+      putbuf((char *)bounce,chunk);
+      done += chunk;
     }
-  return -1;
+  palloc_free_page(bounce);
+  return size;
 }
 
+/* Writes SIZE bytes from user BUFFER to FD. */
 int
 syscall_write(int fd, const void *buffer, unsigned size)
 {
-  if (!is_valid_ptr(buffer))
+  if(fd == 1)
+    return console_write_user(buffer, size);
+  return file_xfer_fd(fd, (void *) buffer, size, -1, true);
+}
+
+/* Reads up to SIZE bytes at offset OFFSET of FD's file into user
+   BUFFER, without moving the file position. */
+int
+syscall_pread(int fd, void *buffer, unsigned size, unsigned offset)
+{
+  if ((off_t) offset < 0)
+    return -1;
+  return file_xfer_fd(fd, buffer, size, offset, false);
+}
+
+/* Writes SIZE bytes from user BUFFER at offset OFFSET of FD's
+   file, without moving the file position. */
+int
+syscall_pwrite(int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  if ((off_t) offset < 0)
+    return -1;
+  return file_xfer_fd(fd, (void *) buffer, size, offset, true);
+}
+
+/* Reads or writes, as WRITE says, the IOVCNT user buffers
+   described by the user array UIOV, in order, starting at the
+   current position of FD's file, which is then advanced.  The
+   whole call takes filesys_lock once, and writing to the console
+   is allowed.  Returns the number of bytes moved, which is short
+   if a transfer stops early, or -1 if nothing was moved because FD
+   is not open, IOVCNT is out of range or memory is short. */
+static int
+file_xfer_vec (int fd, const struct iovec *uiov, int iovcnt, bool write)
+{
+  struct iovec iov[IOV_MAX];
+  struct file *file = NULL;
+  uint8_t *bounce;
+  off_t ofs = 0;
+  int i, total = 0;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return -1;
+  if (!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
     syscall_exit(-1);
 
-  if(fd == 1)
+  if (write && fd == 1)
     {
-      //for (i = 0; i < size; i++)
-      //  if(!*((char *)buffer + i)) break;
-      putbuf((char *)buffer,(size_t)size);
-      return size;
+      for (i = 0; i < iovcnt; i++)
+        if (console_write_user(iov[i].iov_base, iov[i].iov_len) < 0)
+          return total > 0 ? total : -1;
+        else
+          total += iov[i].iov_len;
+      return total;
     }
+  file = search_file(fd);
+  if (file == NULL)
+    return -1;
+  bounce = palloc_get_page(0);
+  if (bounce == NULL)
+    return -1;
+
+  if (write)
+    rwlock_acquire_exclusive (&filesys_lock);
   else
+    rwlock_acquire_shared (&filesys_lock);
+  ofs = file_tell(file);
+  for (i = 0; i < iovcnt; i++)
     {
-      struct file* file = search_file(fd);
-      if(file == NULL) return -1;
+      int result = file_xfer(file, iov[i].iov_base, iov[i].iov_len,
+                             ofs + total, write, bounce);
+      if (result < 0)
+        {
+          total = -1;
+          break;
+        }
+      total += result;
+      if ((size_t) result < iov[i].iov_len)
+        break;
+    }
+  if (total > 0)
+    file_seek(file, ofs + total);
+  if (write)
+    rwlock_release_exclusive (&filesys_lock);
+  else
+    rwlock_release_shared (&filesys_lock);
 
-      int result;
-      lock_acquire(&filesys_lock);
-      result = (int)file_write(file,buffer,(off_t)size);
-      lock_release(&filesys_lock);
-      return result;
+  palloc_free_page(bounce);
+  if (total < 0)
+    syscall_exit(-1);
+  return total;
+}
+
+/* Reads from FD into the IOVCNT buffers of IOV. */
+int
+syscall_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+  return file_xfer_vec(fd, iov, iovcnt, false);
+}
+
+/* Writes the IOVCNT buffers of IOV to FD. */
+int
+syscall_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+  return file_xfer_vec(fd, iov, iovcnt, true);
+}
+
+/* Registers RING, which must be page-aligned user memory, as the
+   running process's I/O rings and empties them.  See
+   lib/ioring.h. */
+bool
+syscall_ioring_setup(struct ioring *ring)
+{
+  static const uint32_t zero[4];
+
+  if (pg_ofs(ring) != 0 || !copy_to_user(ring, zero, sizeof zero))
+    return false;
+  thread_current()->ioring = ring;
+  return true;
+}
+
+/* Carries out submitted operation SQE and returns its result.
+   Each operation behaves like the system call it stands for, so
+   that a bad buffer kills the process, except that a bad file
+   name or descriptor only fails the operation. */
+static int
+ioring_execute(const struct ioring_sqe *sqe)
+{
+  switch (sqe->op)
+    {
+    case IORING_OP_NOP:
+      return 0;
+    case IORING_OP_READ:
+      if (sqe->offset < 0)
+        return syscall_read(sqe->fd, sqe->buf, sqe->len);
+      return syscall_pread(sqe->fd, sqe->buf, sqe->len, sqe->offset);
+    case IORING_OP_WRITE:
+      if (sqe->offset < 0)
+        return syscall_write(sqe->fd, sqe->buf, sqe->len);
+      return syscall_pwrite(sqe->fd, sqe->buf, sqe->len, sqe->offset);
+    case IORING_OP_OPEN:
+      {
+        char name[NAME_MAX + 2];
+
+        if (!copy_in_name(name, sqe->buf))
+          return -1;
+        return syscall_open(name);
+      }
+    case IORING_OP_CLOSE:
+      if (search_file(sqe->fd) == NULL)
+        return -1;
+      syscall_close(sqe->fd);
+      return 0;
+    default:
+      return -1;
     }
-  return -1;
+}
+
+/* Carries out the operations submitted on the running process's
+   I/O rings, as many as the completion ring has room for, posting
+   each result as it goes.  Returns the number of operations
+   carried out, or -1 if no rings are registered. */
+int
+syscall_ioring_enter(void)
+{
+  struct ioring *ring = thread_current()->ioring;
+  uint32_t sq_head, sq_tail, cq_head, cq_tail;
+  int cnt = 0;
+
+  if (ring == NULL)
+    return -1;
+  if (!copy_from_user(&sq_head, &ring->sq_head, sizeof sq_head)
+      || !copy_from_user(&sq_tail, &ring->sq_tail, sizeof sq_tail)
+      || !copy_from_user(&cq_head, &ring->cq_head, sizeof cq_head)
+      || !copy_from_user(&cq_tail, &ring->cq_tail, sizeof cq_tail))
+    syscall_exit(-1);
+
+  while (sq_head != sq_tail && cq_tail - cq_head < IORING_ENTRIES)
+    {
+      struct ioring_sqe sqe;
+      struct ioring_cqe cqe;
+
+      if (!copy_from_user(&sqe, &ring->sq[sq_head % IORING_ENTRIES],
+                          sizeof sqe))
+        syscall_exit(-1);
+      cqe.user_data = sqe.user_data;
+      cqe.result = ioring_execute(&sqe);
+      if (!copy_to_user(&ring->cq[cq_tail % IORING_ENTRIES], &cqe,
+                        sizeof cqe))
+        syscall_exit(-1);
+      sq_head++;
+      cq_tail++;
+      cnt++;
+    }
+
+  if (!copy_to_user(&ring->sq_head, &sq_head, sizeof sq_head)
+      || !copy_to_user(&ring->cq_tail, &cq_tail, sizeof cq_tail))
+    syscall_exit(-1);
+  return cnt;
 }
 
 int
@@ -375,47 +808,122 @@ syscall_sum_of_four_integers(int a, int b, int c, int d)
   return a+b+c+d;
 }
 
+/* Copies the running thread's scheduler statistics to STATS. */
+bool
+syscall_schedstat(struct schedstat *stats)
+{
+  struct schedstat copy;
+  enum intr_level old_level;
+
+  old_level = intr_disable();
+  copy = thread_current()->schedstat;
+  intr_set_level(old_level);
+
+  if (!copy_to_user(stats, &copy, sizeof copy))
+    syscall_exit(-1);
+  return true;
+}
+
+/* Sets the base priority of process PID to PRIORITY.  Without
+   privilege a process may only lower a priority.  Fails in MLFQS
+   mode, where priorities are computed; use nice() there. */
+bool
+syscall_setpriority(pid_t pid, int priority)
+{
+  struct thread *t;
+
+  if (thread_mlfqs || priority < PRI_MIN || priority > PRI_MAX)
+    return false;
+  t = sched_target(pid);
+  if (t == NULL
+      || (priority > t->base_priority && !sched_privileged()))
+    return false;
+
+  thread_set_priority_of(t, priority);
+  return true;
+}
+
+/* Returns the effective priority of process PID, or -1. */
+int
+syscall_getpriority(pid_t pid)
+{
+  struct thread *t = sched_target(pid);
+
+  return t != NULL ? t->priority : -1;
+}
+
+/* Adds INCREMENT to the nice value of process PID and returns
+   the new value, or NICE_ERROR.  Without privilege a process may
+   only raise a nice value. */
+int
+syscall_nice(pid_t pid, int increment)
+{
+  struct thread *t = sched_target(pid);
+  int new_nice;
+
+  if (t == NULL || increment < NICE_MIN - NICE_MAX
+      || increment > NICE_MAX - NICE_MIN)
+    return NICE_ERROR;
+  new_nice = t->nice + increment;
+  if (new_nice < NICE_MIN)
+    new_nice = NICE_MIN;
+  if (new_nice > NICE_MAX)
+    new_nice = NICE_MAX;
+  if (new_nice < t->nice && !sched_privileged())
+    return NICE_ERROR;
+
+  thread_set_nice_of(t, new_nice);
+  return new_nice;
+}
+
 bool
 syscall_create(const char *file, unsigned initial_size)
 {
-  if (!is_valid_ptr(file) || !(*file))
+  if (!(*file))
     syscall_exit(-1);
 
   bool result;
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_exclusive (&filesys_lock);
   result = filesys_create(file,(off_t)initial_size);
-  lock_release(&filesys_lock);
+  rwlock_release_exclusive (&filesys_lock);
   return result;
 }
 bool
 syscall_remove(const char *file)
 {
-  if (!is_valid_ptr(file) || !(*file))
+  if (!(*file))
     syscall_exit(-1);
 
   bool result;
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_exclusive (&filesys_lock);
   result = filesys_remove(file);
-  lock_release(&filesys_lock);
+  rwlock_release_exclusive (&filesys_lock);
   return result;
 }
 int
 syscall_open(const char *file)
 {
-  if (!is_valid_ptr(file))
-    syscall_exit(-1);
   if (!(*file))
     return -1;
 
   struct file* op_file;
-  lock_acquire(&filesys_lock);
+  int fd;
+  rwlock_acquire_shared (&filesys_lock);
   op_file = filesys_open(file);
-  lock_release(&filesys_lock);
+  rwlock_release_shared (&filesys_lock);
 
   if (!op_file)
     return -1;
 
-  return thread_add_file(op_file);
+  fd = thread_add_file(op_file);
+  if (fd < 0)
+    {
+      /* The descriptor table is full. */
+      rwlock_acquire_exclusive (&filesys_lock);
+      file_close(op_file);
+      rwlock_release_exclusive (&filesys_lock);
+    }
+  return fd;
 }
 int
 syscall_filesize(int fd)
@@ -424,9 +932,9 @@ syscall_filesize(int fd)
   if(file == NULL) return -1;
 
   int result;
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_shared (&filesys_lock);
   result = (int)file_length(file);
-  lock_release(&filesys_lock);
+  rwlock_release_shared (&filesys_lock);
   return result;
 }
 void
@@ -435,9 +943,9 @@ syscall_seek(int fd, unsigned position)
   struct file* file = search_file(fd);
   if(file == NULL) return;
 
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_shared (&filesys_lock);
   file_seek(file,(off_t)position);
-  lock_release(&filesys_lock);
+  rwlock_release_shared (&filesys_lock);
   return ;
 }
 
@@ -448,65 +956,55 @@ syscall_tell(int fd)
   if(file == NULL) return -1;
 
   unsigned result;
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_shared (&filesys_lock);
   result = (unsigned)file_tell(file);
-  lock_release(&filesys_lock);
+  rwlock_release_shared (&filesys_lock);
   return result;
 }
 void
 syscall_close(int fd)
 {
-  struct file* file = search_file(fd);
+  struct file* file = thread_remove_file(fd);
   if(file == NULL) syscall_exit(-1);
 
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_exclusive (&filesys_lock);
   file_close(file);
-  lock_release(&filesys_lock);
+  rwlock_release_exclusive (&filesys_lock);
+}
 
-  struct thread* cur = thread_current();
+/* Returns the thread of process PID, whose scheduling the
+   caller may change: the caller itself if PID is 0 or its own
+   pid, otherwise one of its children.  Returns NULL for any
+   other PID.  A child stays on its parent's child_list until it
+   exits, which it cannot do before its parent waits for it. */
+static struct thread *
+sched_target (pid_t pid)
+{
+  struct thread *cur = thread_current ();
   struct list_elem *e;
-  struct file_list *ftemp;
 
-  for (e = list_begin(&cur->filelist); e != list_end(&cur->filelist);
-       e = list_next(e))
+  if (pid == 0 || pid == cur->tid)
+    return cur;
+  for (e = list_begin (&cur->child_list); e != list_end (&cur->child_list);
+       e = list_next (e))
     {
-      ftemp = list_entry(e, struct file_list, ptr);
-      if (fd == ftemp->fd)
-        {
-          list_remove(e);
-          free(ftemp);
-          break;
-        }
+      struct thread *c = list_entry (e, struct thread, child_elem);
+      if (c->tid == pid)
+        return c;
     }
+  return NULL;
 }
 
+/* Returns true if the running process may raise priorities: it
+   was started by the kernel rather than by another process, as
+   is the shell. */
 static bool
-is_valid_arg (const void* esp, int argc)
+sched_privileged (void)
 {
-  int i;
-  void* argv_ptr = NULL;
-
-  for (i = 0; i < argc; i++)
-    {
-      argv_ptr = ESP_ARGV_PTR(esp, i); // ith argv pointer
-
-      if (!is_valid_ptr(argv_ptr)) {
-        return false;
-      }
-    }
-
-  return true;
+  return thread_current ()->parent->pagedir == NULL;
 }
 
 struct file* search_file(int fd)
 {
-  struct thread* current = thread_current();
-  struct list_elem *e;
-
-  for(e = list_begin(&current->filelist); e != list_end(&current->filelist); e = list_next(e))
-    {
-      if(fd == list_entry(e,struct file_list,ptr)->fd)
-          return list_entry(e,struct file_list,ptr)->file;
-    }
-  return NULL;
+  return thread_get_file(fd);
 }
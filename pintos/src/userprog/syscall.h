@@ -1,7 +1,10 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stdint.h>
+
 void syscall_init (void);
 void syscall_exit(int status);
+uint32_t syscall_fast (void *esp);
 
 #endif /* userprog/syscall.h */
@@ -2,6 +2,7 @@
 #include <debug.h>
 #include <stddef.h>
 #include "userprog/gdt.h"
+#include "threads/cpu.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -75,6 +76,10 @@ struct tss
 /* Kernel TSS. */
 static struct tss *tss;
 
+/* True once SYSENTER is in use, so that its stack pointer MSR
+   must track esp0. */
+static bool sysenter_enabled;
+
 /* Initializes the kernel TSS. */
 void
 tss_init (void) 
@@ -97,10 +102,26 @@ tss_get_ (void)
 }
 
 /* Sets the ring 0 stack pointer in the TSS to point to the end
-   of the thread stack. */
+   of the thread stack, and the one SYSENTER loads along with
+   it.  SYSENTER does not consult the TSS, but it needs the same
+   stack for the same reason. */
 void
 tss_update (void) 
+{
+  void *esp0 = (uint8_t *) thread_current () + PGSIZE;
+
+  ASSERT (tss != NULL);
+  if (sysenter_enabled && tss->esp0 != esp0)
+    wrmsr (MSR_SYSENTER_ESP, (uintptr_t) esp0);
+  tss->esp0 = esp0;
+}
+
+/* Makes tss_update() keep SYSENTER's stack pointer in step with
+   esp0 from now on. */
+void
+tss_enable_sysenter (void) 
 {
   ASSERT (tss != NULL);
-  tss->esp0 = (uint8_t *) thread_current () + PGSIZE;
+  sysenter_enabled = true;
+  wrmsr (MSR_SYSENTER_ESP, (uintptr_t) tss->esp0);
 }
@@ -7,5 +7,6 @@ struct tss;
 void tss_init (void);
 struct tss *tss_get_ (void);
 void tss_update (void);
+void tss_enable_sysenter (void);
 
 #endif /* userprog/tss.h */
@@ -0,0 +1,148 @@
+#include "userprog/uaccess.h"
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Access to user memory.
+
+   The primitives here copy between the kernel and user memory
+   without first checking that the user pages are mapped.  They
+   only check that the user range lies below PHYS_BASE, and then
+   copy at full speed.  If a user page turns out to be missing,
+   the kernel-mode page fault lands on one of the instructions
+   listed in the exception table, and page_fault() calls
+   uaccess_fixup() to resume at that instruction's fixup code
+   instead of treating the fault as fatal.  The fixup code makes
+   the primitive return an error.
+
+   Each exception table entry pairs the address of an
+   instruction that may fault on user memory with the address at
+   which to continue.  The linker script gathers the entries
+   from the `__ex_table' sections into one array. */
+struct ex_entry
+  {
+    uintptr_t insn;             /* Faulting instruction. */
+    uintptr_t fixup;            /* Where to continue. */
+  };
+
+extern const struct ex_entry _start_ex_table[], _end_ex_table[];
+
+/* Copies SIZE bytes from SRC to DST, either of which may be in
+   user memory, and returns the number of bytes that could not be
+   copied because of a fault: 0 on success.  Copies four bytes at
+   a time with `rep movsl', then the rest with `rep movsb'.  Both
+   leave %ecx holding the count not yet moved when they fault. */
+static size_t
+uaccess_copy (void *dst, const void *src, size_t size) 
+{
+  size_t left;
+  int d0, d1;
+
+  asm volatile ("1: rep movsl\n"
+                "   movl %[tail], %%ecx\n"
+                "2: rep movsb\n"
+                "3:\n"
+                ".section .fixup, \"ax\"\n"
+                "4: leal (%[tail], %%ecx, 4), %%ecx\n"
+                "   jmp 3b\n"
+                ".previous\n"
+                ".section __ex_table, \"a\"\n"
+                "   .long 1b, 4b\n"
+                "   .long 2b, 3b\n"
+                ".previous"
+                : "=c" (left), "=&D" (d0), "=&S" (d1)
+                : "0" (size / 4), "1" (dst), "2" (src), [tail] "r" (size % 4)
+                : "memory");
+  return left;
+}
+
+/* Returns true if the SIZE bytes starting at UADDR all lie in
+   user virtual memory. */
+static bool
+user_range (const void *uaddr, size_t size) 
+{
+  uintptr_t start = (uintptr_t) uaddr;
+
+  return start + size >= start && start + size <= (uintptr_t) PHYS_BASE;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if any of the user
+   bytes is not mapped or lies outside user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) 
+{
+  return user_range (usrc, size) && uaccess_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if any of the user
+   bytes is not mapped or lies outside user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) 
+{
+  return user_range (udst, size) && uaccess_copy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   the SIZE bytes at DST.  Returns the length of the string, not
+   counting its null terminator.  If the string does not fit,
+   copies SIZE bytes without a terminator and returns SIZE.
+   Returns -1 if the string runs into an unmapped page or out of
+   user memory. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size) 
+{
+  size_t max, len;
+  int fault;
+
+  if (!is_user_vaddr (usrc))
+    return -1;
+  max = (const char *) PHYS_BASE - usrc;
+  if (max > size)
+    max = size;
+
+  asm volatile ("   xorl %[len], %[len]\n"
+                "   xorl %[fault], %[fault]\n"
+                "5: cmpl %[max], %[len]\n"
+                "   je 7f\n"
+                "6: movb (%[src], %[len]), %%al\n"
+                "   movb %%al, (%[dst], %[len])\n"
+                "   testb %%al, %%al\n"
+                "   je 7f\n"
+                "   incl %[len]\n"
+                "   jmp 5b\n"
+                "7:\n"
+                ".section .fixup, \"ax\"\n"
+                "8: movl $1, %[fault]\n"
+                "   jmp 7b\n"
+                ".previous\n"
+                ".section __ex_table, \"a\"\n"
+                "   .long 6b, 8b\n"
+                ".previous"
+                : [len] "=&r" (len), [fault] "=&r" (fault)
+                : [max] "r" (max), [src] "r" (usrc), [dst] "r" (dst)
+                : "eax", "memory");
+
+  if (fault || (len == max && max < size))
+    return -1;
+  return len;
+}
+
+/* Called by the page fault handler for a fault in kernel mode.
+   If the faulting instruction is one of the user accesses above,
+   redirects F to resume at its fixup code and returns true.
+   Otherwise returns false. */
+bool
+uaccess_fixup (struct intr_frame *f) 
+{
+  const struct ex_entry *e;
+
+  for (e = _start_ex_table; e < _end_ex_table; e++)
+    if (e->insn == (uintptr_t) f->eip)
+      {
+        f->eip = (void (*) (void)) e->fixup;
+        return true;
+      }
+  return false;
+}